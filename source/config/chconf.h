@@ -575,7 +575,7 @@
  * @note    The default is @p FALSE.
  */
 #if !defined(CH_DBG_STATISTICS)
-#define CH_DBG_STATISTICS FALSE
+#define CH_DBG_STATISTICS TRUE
 #endif
 
 /**
@@ -654,7 +654,7 @@
  * @note    The default is @p FALSE.
  */
 #if !defined(CH_DBG_FILL_THREADS)
-#define CH_DBG_FILL_THREADS FALSE
+#define CH_DBG_FILL_THREADS TRUE
 #endif
 
 /**
@@ -715,7 +715,9 @@
  * @brief   Threads descriptor structure extension.
  * @details User fields added to the end of the @p thread_t structure.
  */
-#define CH_CFG_THREAD_EXTRA_FIELDS /* Add threads custom fields here.*/
+#define CH_CFG_THREAD_EXTRA_FIELDS                                      \
+    /* Deferred log ring of the thread, see utility/deferred_log.cpp.*/ \
+    void* log_writer;
 
 /**
  * @brief   Threads initialization hook.
@@ -726,9 +728,9 @@
  *
  * @param[in] tp        pointer to the @p thread_t structure
  */
-#define CH_CFG_THREAD_INIT_HOOK(tp)                \
-    {                                              \
-        /* Add threads initialization code here.*/ \
+#define CH_CFG_THREAD_INIT_HOOK(tp) \
+    {                               \
+        (tp)->log_writer = NULL;    \
     }
 
 /**
@@ -754,20 +756,32 @@
         /* Context switch code here.*/       \
     }
 
+#if !defined(_FROM_ASM_)
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* ISR time accounting, see impl/profiler.cpp.*/
+void profIrqEnter(void);
+void profIrqExit(void);
+#ifdef __cplusplus
+}
+#endif
+#endif
+
 /**
  * @brief   ISR enter hook.
  */
-#define CH_CFG_IRQ_PROLOGUE_HOOK()   \
-    {                                \
-        /* IRQ prologue code here.*/ \
+#define CH_CFG_IRQ_PROLOGUE_HOOK() \
+    {                              \
+        profIrqEnter();            \
     }
 
 /**
  * @brief   ISR exit hook.
  */
-#define CH_CFG_IRQ_EPILOGUE_HOOK()   \
-    {                                \
-        /* IRQ epilogue code here.*/ \
+#define CH_CFG_IRQ_EPILOGUE_HOOK() \
+    {                              \
+        profIrqExit();             \
     }
 
 /**
@@ -104,8 +104,15 @@
 #define STM32_ADC_USE_ADC1 TRUE
 #define STM32_ADC_ADC1_DMA_STREAM STM32_DMA_STREAM_ID(2, 4)
 #define STM32_ADC_ADC1_DMA_PRIORITY 2
-#define STM32_ADC_IRQ_PRIORITY 6
+#define STM32_ADC_IRQ_PRIORITY 3
 #define STM32_ADC_ADC1_DMA_IRQ_PRIORITY 6
+/* The analog watchdog cuts the heaters off, see Overheat. The interrupt is
+   kernel aware, the critical zones delay the cutoff. */
+#define STM32_ADC_ADC1_IRQ_HOOK                                             \
+  if (sr & ADC_SR_AWD) {                                                    \
+    extern void overheatWatchdogHook(void);                                 \
+    overheatWatchdogHook();                                                 \
+  }
 
 /*
  * GPT driver system settings.
@@ -182,7 +189,7 @@
 /*
  * SERIAL driver system settings.
  */
-#define STM32_SERIAL_USE_USART1 TRUE
+#define STM32_SERIAL_USE_USART1 FALSE
 #define STM32_SERIAL_USE_USART2 FALSE
 #define STM32_SERIAL_USE_USART6 TRUE
 
@@ -215,7 +222,7 @@
 /*
  * UART driver system settings.
  */
-#define STM32_UART_USE_USART1 FALSE
+#define STM32_UART_USE_USART1 TRUE
 #define STM32_UART_USE_USART2 FALSE
 #define STM32_UART_USE_USART6 FALSE
 #define STM32_UART_USART1_RX_DMA_STREAM STM32_DMA_STREAM_ID(2, 5)
@@ -21,12 +21,15 @@
  */
 
 #include "backlight.h"
+#include "config_store.h"
 #include "hal.h"
+#include <algorithm>
 
 namespace Drivers {
 namespace Bl {
 
 constexpr auto PWM_RESOLUTION = 16;
+constexpr int8_t DEFAULT_HUE = 4;
 
 enum Ch {
     CH_RED,
@@ -68,14 +71,13 @@ static void Update()
     }
     pwmEnableChannel(&PWMD3, CH_RED, redVal);
     pwmEnableChannel(&PWMD3, CH_GREEN, greenVal);
-    // TODO: Store hue to EEPROM after timeout
+    Config::Set(Config::BACKLIGHT_HUE, hueVal);
 }
 
 void Init()
 {
-    // TODO: Get config values from EEPROM
     pwmStart(&PWMD3, &pwmcfg);
-    hueVal = 4;
+    hueVal = int8_t(std::clamp<Config::value_t>(Config::Get(Config::BACKLIGHT_HUE, DEFAULT_HUE), -16, 16));
     Update();
 }
 
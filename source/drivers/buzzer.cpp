@@ -22,15 +22,19 @@
 
 #include "buzzer.h"
 #include "hal.h"
+#include "spsc_ring.h"
+#include <algorithm>
 
 namespace Drivers {
 namespace Buzzer {
 
-constexpr auto PWM_RESOLUTION = 2;
+constexpr auto PWM_CLOCK = 1'000'000;
+constexpr auto DEFAULT_FREQUENCY = 1500;
+constexpr size_t QUEUE_SIZE = 16;
 
 static const PWMConfig pwmcfg = {
-  .frequency = 1500 * PWM_RESOLUTION, /* 2.5kHz PWM clock frequency. */
-  .period = PWM_RESOLUTION,
+  .frequency = PWM_CLOCK, /* 1MHz PWM clock frequency. */
+  .period = PWM_CLOCK / DEFAULT_FREQUENCY,
   .callback = nullptr, /* Period callback. */
   .channels =
     {
@@ -44,16 +48,93 @@ static const PWMConfig pwmcfg = {
   .dier = 0, /* DMA/Interrupt Enable Register. */
 };
 
+enum class Phase {
+    IDLE,
+    TONE,
+    GAP
+};
+
+// Filled by the callers, drained by the timer callback
+static Utils::SpscRing<Tone, QUEUE_SIZE> queue;
+static MUTEX_DECL(producerLock);
+static virtual_timer_t stepTimer;
+// Owned by the timer callback, or by a caller under the system lock while idle
+static Phase phase;
+static Tone current;
+static uint8_t playsLeft;
+
+static void Step();
+
+static void stepTimerCallback(virtual_timer_t*, void*)
+{
+    chSysLockFromISR();
+    Step();
+    chSysUnlockFromISR();
+}
+
+static void StartTone()
+{
+    if(current.frequency) {
+        auto period = PWM_CLOCK / current.frequency;
+        pwmChangePeriodI(&PWMD2, period);
+        pwmEnableChannelI(&PWMD2, 0, period / 2);
+    }
+    phase = Phase::TONE;
+    chVTSetI(&stepTimer, TIME_MS2I(std::max<uint16_t>(current.durationMs, 1)), stepTimerCallback, nullptr);
+}
+
+// Advances the sequence, I-class
+static void Step()
+{
+    if(phase == Phase::TONE) {
+        pwmDisableChannelI(&PWMD2, 0);
+        if(current.gapMs) {
+            phase = Phase::GAP;
+            chVTSetI(&stepTimer, TIME_MS2I(current.gapMs), stepTimerCallback, nullptr);
+            return;
+        }
+    }
+    if(playsLeft) {
+        --playsLeft;
+        StartTone();
+    }
+    else if(queue.Pop(current)) {
+        playsLeft = current.repeat ? current.repeat - 1 : 0;
+        StartTone();
+    }
+    else {
+        phase = Phase::IDLE;
+    }
+}
+
 void Init()
 {
+    chVTObjectInit(&stepTimer);
     pwmStart(&PWMD2, &pwmcfg);
 }
 
+bool Play(const Tone* tones, size_t count)
+{
+    chMtxLock(&producerLock);
+    bool fits = queue.Free() >= count;
+    if(fits) {
+        for(size_t i{}; i < count; ++i) {
+            queue.Push(tones[i]);
+        }
+        chSysLock();
+        if(phase == Phase::IDLE) {
+            Step();
+        }
+        chSysUnlock();
+    }
+    chMtxUnlock(&producerLock);
+    return fits;
+}
+
 void Beep(BuzType type)
 {
-    pwmEnableChannel(&PWMD2, 0, 1);
-    chThdSleepMilliseconds(type == BuzType::SHORT ? 35 : 500);
-    pwmDisableChannel(&PWMD2, 0);
+    const Tone tone{.frequency = DEFAULT_FREQUENCY, .durationMs = uint16_t(type == BuzType::SHORT ? 35 : 500)};
+    Play(&tone, 1);
 }
 
 } // Buzzer
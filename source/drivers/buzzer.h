@@ -23,6 +23,9 @@
 #ifndef BUZZER_H
 #define BUZZER_H
 
+#include <cstddef>
+#include <cstdint>
+
 namespace Drivers {
 namespace Buzzer {
 
@@ -31,10 +34,25 @@ enum class BuzType {
     LONG
 };
 
+struct Tone
+{
+    uint16_t frequency; // Hz, zero makes a pause
+    uint16_t durationMs;
+    uint16_t gapMs; // Silence after each play of the tone
+    uint8_t repeat; // Number of plays, zero counts as one
+};
+
 /**
  * @brief init underlying PWM module
  */
 void Init();
+
+/**
+ * @brief Queue a pattern and return immediately, the tones are played from a virtual timer.
+ * A single caller thread at a time, the callers are serialized by a mutex.
+ * @return false if the queue has not enough room, nothing is queued in that case
+ */
+bool Play(const Tone* tones, size_t count);
 void Beep(BuzType type = BuzType::SHORT);
 
 } // Buzzer
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "heater.h"
+#include "hal.h"
+#include <algorithm>
+
+namespace Drivers {
+namespace Heater {
+
+enum OutputMode : uint32_t {
+    ACTIVE_ON_MATCH = 0b001,
+    INACTIVE_ON_MATCH = 0b010,
+    FORCED_INACTIVE = 0b100,
+};
+
+struct OnTime
+{
+    uint32_t start;
+    uint32_t end; // Off when equals to start
+};
+
+static void periodCallback(PWMDriver* pwmp);
+template<uint32_t ch>
+static void channelCallback(PWMDriver* pwmp);
+
+static const PWMConfig pwmcfg = {
+  .frequency = TICK_FREQUENCY,
+  .period = PERIOD,
+  .callback = periodCallback, /* Period callback. */
+  .channels =
+    {
+      {PWM_OUTPUT_ACTIVE_HIGH, channelCallback<IRON_1>}, /* CH1 mode and callback. */
+      {PWM_OUTPUT_ACTIVE_HIGH, channelCallback<IRON_2>}, /* CH2 mode and callback. */
+      {PWM_OUTPUT_ACTIVE_HIGH, channelCallback<IRON_3>}, /* CH3 mode and callback. */
+      {PWM_OUTPUT_DISABLED, NULL}                        /* CH4 mode and callback. */
+    },
+  .cr2 = TIM_CR2_MMS_1, /* TRGO on update, restarts the ADC trigger timer. */
+  .bdtr = 0,
+  .dier = 0, /* DMA/Interrupt Enable Register. */
+};
+
+static uint32_t settleTicks = DEFAULT_SETTLE_TICKS;
+static OnTime pending[CHANNELS_NUM];
+static OnTime active[CHANNELS_NUM];
+static volatile bool cutOff;
+static volatile uint32_t periodStamp;
+
+static uint32_t OnRegionEnd()
+{
+    return SAMPLING_TICKS - settleTicks;
+}
+
+// Compare output mode without preload, so it takes effect immediately
+static void SetOutputMode(uint32_t ch, OutputMode mode)
+{
+    auto& ccmr = ch < 2 ? PWMD1.tim->CCMR1 : PWMD1.tim->CCMR2;
+    auto shift = (ch & 1) ? 12 : 4;
+    ccmr = (ccmr & ~(0x0FU << (shift - 1))) | (mode << shift);
+}
+
+static OutputMode GetOutputMode(uint32_t ch)
+{
+    auto ccmr = ch < 2 ? PWMD1.tim->CCMR1 : PWMD1.tim->CCMR2;
+    auto shift = (ch & 1) ? 12 : 4;
+    return OutputMode((ccmr >> shift) & 0x07);
+}
+
+static void periodCallback(PWMDriver* pwmp)
+{
+    periodStamp = chSysGetRealtimeCounterX();
+    for(uint32_t ch{}; ch < CHANNELS_NUM; ++ch) {
+        SetOutputMode(ch, FORCED_INACTIVE);
+        if(cutOff) {
+            continue;
+        }
+        active[ch] = pending[ch];
+        if(active[ch].end > active[ch].start) {
+            pwmp->tim->CCR[ch] = active[ch].start;
+            SetOutputMode(ch, ACTIVE_ON_MATCH);
+            // Served after the start, the on-time of this period is skipped rather than matched in the next one
+            if(pwmp->tim->CNT >= active[ch].start) {
+                SetOutputMode(ch, FORCED_INACTIVE);
+            }
+        }
+    }
+}
+
+template<uint32_t ch>
+static void channelCallback(PWMDriver* pwmp)
+{
+    // Before the start, it is a match of the previous compare value, taken ahead of the period interrupt
+    if(GetOutputMode(ch) != ACTIVE_ON_MATCH || pwmp->tim->CNT < active[ch].start) {
+        return;
+    }
+    // Switched on, arm the switch off point
+    pwmp->tim->CCR[ch] = active[ch].end;
+    SetOutputMode(ch, INACTIVE_ON_MATCH);
+    if(pwmp->tim->CNT >= active[ch].end) {
+        SetOutputMode(ch, FORCED_INACTIVE);
+    }
+}
+
+static void StartAdcTrigger()
+{
+    rccEnableTIM4(true);
+    rccResetTIM4();
+    auto* tim = STM32_TIM4;
+    tim->PSC = (STM32_TIMCLK1 / TICK_FREQUENCY) - 1;
+    tim->ARR = 0xFFFF;
+    // Reset mode slave of TIM1 (ITR0), so the counter runs in phase with the heater period
+    tim->SMCR = TIM_SMCR_SMS_2;
+    // PWM mode 2: OC4REF rises at the sampling point, the ADC triggers on that edge
+    tim->CCMR2 = TIM_CCMR2_OC4M_2 | TIM_CCMR2_OC4M_1 | TIM_CCMR2_OC4M_0;
+    tim->CCR[3] = SAMPLING_TICKS;
+    tim->EGR = TIM_EGR_UG;
+    tim->CR1 = TIM_CR1_CEN;
+}
+
+void Init()
+{
+    static_assert(STM32_TIMCLK1 == STM32_TIMCLK2, "TIM1 and TIM4 must count at the same rate");
+    StartAdcTrigger();
+    pwmStart(&PWMD1, &pwmcfg);
+    for(uint32_t ch{}; ch < CHANNELS_NUM; ++ch) {
+        SetOutputMode(ch, FORCED_INACTIVE);
+        // Parked past the period end, a match at zero would be taken for the switch on of the first on-time
+        pwmEnableChannel(&PWMD1, ch, PERIOD);
+        pwmEnableChannelNotification(&PWMD1, ch);
+    }
+    pwmEnablePeriodicNotification(&PWMD1);
+    palSetLine(LINE_PWM_EN);
+}
+
+static OnTime Clamp(uint32_t start, uint32_t ticks)
+{
+    auto end = std::min(MIN_START + start + ticks, OnRegionEnd());
+    start = std::min(MIN_START + start, end);
+    return {start, end};
+}
+
+void SetSettleTime(uint32_t ticks)
+{
+    ticks = std::min(ticks, PERIOD / 2);
+    chSysLock();
+    settleTicks = ticks;
+    for(auto& onTime : pending) {
+        onTime.end = std::min(onTime.end, OnRegionEnd());
+        onTime.start = std::min(onTime.start, onTime.end);
+    }
+    chSysUnlock();
+}
+
+uint32_t GetMaxDuty()
+{
+    return OnRegionEnd() - MIN_START;
+}
+
+void SetOnTime(Channel ch, uint32_t start, uint32_t ticks)
+{
+    chSysLock();
+    pending[ch] = Clamp(start, ticks);
+    chSysUnlock();
+}
+
+bool IsHeatingI(Channel ch)
+{
+    return pending[ch].end > pending[ch].start;
+}
+
+void CutOffX()
+{
+    palClearLine(LINE_PWM_EN);
+    PWMD1.tim->BDTR = PWMD1.tim->BDTR & ~TIM_BDTR_MOE;
+    for(uint32_t ch{}; ch < CHANNELS_NUM; ++ch) {
+        SetOutputMode(ch, FORCED_INACTIVE);
+    }
+    cutOff = true;
+}
+
+bool IsCutOff()
+{
+    return cutOff;
+}
+
+uint32_t GetPeriodStampX()
+{
+    return periodStamp;
+}
+
+} // Heater
+} // Drivers
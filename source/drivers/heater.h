@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef HEATER_H
+#define HEATER_H
+
+#include <cstdint>
+
+namespace Drivers {
+namespace Heater {
+
+enum Channel : uint8_t {
+    IRON_1,
+    IRON_2,
+    IRON_3,
+    CHANNELS_NUM
+};
+
+constexpr uint32_t TICK_FREQUENCY = 100'000;
+constexpr uint32_t PERIOD = 500; // 5 ms
+// Time for the TC1..3 conversions, they are the first in the scan
+constexpr uint32_t TC_CONVERSION_TICKS = 10;
+constexpr uint32_t DEFAULT_SETTLE_TICKS = 30;
+// The earliest switch on point, leaves time for the period interrupt to arm the channels
+constexpr uint32_t MIN_START = 2;
+// The TC conversions are triggered here whatever the settle time, it shifts the on region instead
+constexpr uint32_t SAMPLING_TICKS = PERIOD - TC_CONVERSION_TICKS;
+
+/**
+ * @brief init TIM1 heater PWM and the ADC trigger timer.
+ * Each period ends with a window where all the heaters are off, the thermocouples are sampled
+ * by a TIM4 compare event at the settle time after the window start.
+ * Every channel is switched on and off by compare matches at arbitrary points of the period, which allows
+ * to stagger the on-times. The switch points are re-armed from the TIM1 interrupts, a channel is forced off
+ * at the period start whatever happens.
+ */
+void Init();
+
+/**
+ * @brief Delay between the heaters switch off and the TC sampling, shrinks the maximum duty accordingly
+ */
+void SetSettleTime(uint32_t ticks);
+uint32_t GetMaxDuty();
+
+/**
+ * @brief Switch on point (ticks after MIN_START) and on-time in ticks, applied from the next period.
+ * The on-time is cut at the sampling window start.
+ */
+void SetOnTime(Channel ch, uint32_t start, uint32_t ticks);
+
+/**
+ * @brief The channel has an on-time pending for the next periods
+ */
+bool IsHeatingI(Channel ch);
+
+/**
+ * @brief Drop the driver enable and the TIM1 main output, force the channels inactive.
+ * Only the timer and GPIO registers are touched, callable from any context. Latched until reset,
+ * the on-times are ignored from then on.
+ */
+void CutOffX();
+bool IsCutOff();
+
+/**
+ * @brief Realtime counter value at the last period interrupt
+ */
+uint32_t GetPeriodStampX();
+
+} // Heater
+} // Drivers
+
+#endif // HEATER_H
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include "ch_extended.h"
+#include "hal.h"
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+namespace Drivers {
+
+using Rtos::Status;
+
+/**
+ * @brief Bus policy for the I2C device drivers: a combined write/read transfer to a 7-bit address.
+ * Either part may be empty. The devices are templated on it, so a host fake can stand in for the hardware.
+ */
+template<typename T>
+concept I2cBusType = requires(uint8_t address, const uint8_t* tx, uint8_t* rx, size_t len) {
+    { T::Transfer(address, tx, len, rx, len) } -> std::same_as<Status>;
+};
+
+/**
+ * @brief ChibiOS I2C driver backend, the transfers are DMA driven by the LLD.
+ * The bus is acquired for each transfer, so the devices on it may be served from different threads.
+ */
+template<I2CDriver* Driver, uint32_t CLOCK_SPEED = 400'000>
+struct I2cBus
+{
+    static constexpr sysinterval_t TIMEOUT = TIME_MS2I(10);
+
+    static void Init()
+    {
+        static const I2CConfig config{
+          .op_mode = OPMODE_I2C,
+          .clock_speed = CLOCK_SPEED,
+          .duty_cycle = FAST_DUTY_CYCLE_2,
+        };
+        i2cAcquireBus(Driver);
+        if(Driver->state == I2C_STOP) {
+            i2cStart(Driver, &config);
+        }
+        i2cReleaseBus(Driver);
+    }
+
+    static Status Transfer(uint8_t address, const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen)
+    {
+        i2cAcquireBus(Driver);
+        auto result = txLen ? i2cMasterTransmitTimeout(Driver, address, tx, txLen, rx, rxLen, TIMEOUT)
+                            : i2cMasterReceiveTimeout(Driver, address, rx, rxLen, TIMEOUT);
+        if(result == MSG_TIMEOUT) {
+            // The driver is locked after a timeout, it has to be restarted
+            auto* config = Driver->config;
+            i2cStop(Driver);
+            i2cStart(Driver, config);
+        }
+        i2cReleaseBus(Driver);
+        return result == MSG_OK ? Status::Success : Status::Failure;
+    }
+};
+
+} // Drivers
+
+#endif // I2C_BUS_H
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INA3221_H
+#define INA3221_H
+
+#include "i2c_bus.h"
+#include <array>
+
+namespace Drivers {
+
+/**
+ * @brief TI INA3221 three channel shunt and bus voltage monitor.
+ * The device runs in continuous mode, the results are picked up when the conversion ready flag is set.
+ * The register pointer doesn't auto-increment, so each result register takes its own write/read transfer.
+ */
+template<I2cBusType Bus, uint8_t ADDRESS = 0x40>
+class Ina3221
+{
+public:
+    enum { CHANNELS_NUM = 3 };
+
+    enum Averaging : uint16_t {
+        AVG_1,
+        AVG_4,
+        AVG_16,
+        AVG_64,
+        AVG_128,
+        AVG_256,
+        AVG_512,
+        AVG_1024
+    };
+
+    enum ConversionTime : uint16_t {
+        CT_140US,
+        CT_204US,
+        CT_332US,
+        CT_588US,
+        CT_1100US,
+        CT_2116US,
+        CT_4156US,
+        CT_8244US
+    };
+
+    static constexpr int32_t SHUNT_UV_PER_LSB = 40;
+    static constexpr int32_t BUS_MV_PER_LSB = 8;
+
+    struct Raw
+    {
+        int16_t shunt;
+        int16_t bus;
+    };
+    using Results = std::array<Raw, CHANNELS_NUM>;
+
+    static Status Init(Averaging avg, ConversionTime busCt, ConversionTime shuntCt)
+    {
+        uint16_t id;
+        if(ReadRegister(R_MANUFACTURER_ID, id) != Status::Success || id != MANUFACTURER_ID) {
+            return Status::Failure;
+        }
+        if(ReadRegister(R_DIE_ID, id) != Status::Success || id != DIE_ID) {
+            return Status::Failure;
+        }
+        uint16_t config = CONFIG_CH_ALL | avg << 9 | busCt << 6 | shuntCt << 3 | MODE_CONTINUOUS;
+        return WriteRegister(R_CONFIG, config);
+    }
+
+    /**
+     * @brief Polls and clears the conversion ready flag, set when all the enabled channels are converted
+     */
+    static Status PollConversionReady(bool& ready)
+    {
+        uint16_t mask;
+        auto result = ReadRegister(R_MASK_ENABLE, mask);
+        ready = result == Status::Success && (mask & MASK_CVRF);
+        return result;
+    }
+
+    static Status Read(Results& results)
+    {
+        for(size_t ch{}; ch < CHANNELS_NUM; ++ch) {
+            uint16_t shunt, bus;
+            if(ReadRegister(R_SHUNT_VOLTAGE + ch * 2, shunt) != Status::Success ||
+               ReadRegister(R_BUS_VOLTAGE + ch * 2, bus) != Status::Success) {
+                return Status::Failure;
+            }
+            // 13 bit two's complement values, left aligned
+            results[ch] = {int16_t(int16_t(shunt) >> 3), int16_t(int16_t(bus) >> 3)};
+        }
+        return Status::Success;
+    }
+
+    static constexpr int32_t ShuntMicrovolts(const Raw& raw)
+    {
+        return raw.shunt * SHUNT_UV_PER_LSB;
+    }
+
+    static constexpr int32_t BusMillivolts(const Raw& raw)
+    {
+        return raw.bus * BUS_MV_PER_LSB;
+    }
+private:
+    enum Register : uint8_t {
+        R_CONFIG = 0x00,
+        R_SHUNT_VOLTAGE = 0x01, // Shunt/bus pairs for the channels 1..3
+        R_BUS_VOLTAGE = 0x02,
+        R_MASK_ENABLE = 0x0F,
+        R_MANUFACTURER_ID = 0xFE,
+        R_DIE_ID = 0xFF,
+    };
+
+    static constexpr uint16_t CONFIG_CH_ALL = 0b111 << 12;
+    static constexpr uint16_t MODE_CONTINUOUS = 0b111; // Shunt and bus
+    static constexpr uint16_t MASK_CVRF = 1 << 0;
+    static constexpr uint16_t MANUFACTURER_ID = 0x5449;
+    static constexpr uint16_t DIE_ID = 0x3220;
+
+    static Status ReadRegister(uint8_t reg, uint16_t& value)
+    {
+        uint8_t buf[2];
+        if(auto result = Bus::Transfer(ADDRESS, &reg, 1, buf, sizeof(buf)); result != Status::Success) {
+            return result;
+        }
+        value = uint16_t(buf[0] << 8 | buf[1]);
+        return Status::Success;
+    }
+
+    static Status WriteRegister(uint8_t reg, uint16_t value)
+    {
+        const uint8_t buf[]{reg, uint8_t(value >> 8), uint8_t(value)};
+        return Bus::Transfer(ADDRESS, buf, sizeof(buf), nullptr, 0);
+    }
+};
+
+} // Drivers
+
+#endif // INA3221_H
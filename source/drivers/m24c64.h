@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M24C64_H
+#define M24C64_H
+
+#include "ch_port.h"
+#include "i2c_bus.h"
+#include <algorithm>
+
+namespace Drivers {
+
+/**
+ * @brief ST M24C64 8KiB I2C EEPROM. Reads may span any number of pages, writes are limited to one page.
+ */
+template<I2cBusType Bus, uint8_t ADDRESS = 0x50>
+struct M24c64
+{
+    static constexpr size_t SIZE = 8192;
+    static constexpr size_t PAGE_SIZE = 32;
+    static constexpr size_t WRITE_CYCLE_MS = 5;
+
+    static Status Read(uint16_t address, uint8_t* buf, size_t len)
+    {
+        const uint8_t addr[]{uint8_t(address >> 8), uint8_t(address)};
+        return Bus::Transfer(ADDRESS, addr, sizeof(addr), buf, len);
+    }
+
+    /**
+     * @brief Write within one page, returns after the internal write cycle is over
+     */
+    static Status WritePage(uint16_t address, const uint8_t* buf, size_t len)
+    {
+        if(len > PAGE_SIZE - address % PAGE_SIZE) {
+            return Status::Failure;
+        }
+        uint8_t frame[2 + PAGE_SIZE]{uint8_t(address >> 8), uint8_t(address)};
+        std::copy_n(buf, len, &frame[2]);
+        auto result = Bus::Transfer(ADDRESS, frame, 2 + len, nullptr, 0);
+        // The device doesn't respond until the cycle ends, waiting is cheaper than ack polling.
+        // The sleep ends on a tick, the first one may come right after the stop condition, hence the extra tick.
+        delay_ms(WRITE_CYCLE_MS + 1);
+        return result;
+    }
+};
+
+} // Drivers
+
+#endif // M24C64_H
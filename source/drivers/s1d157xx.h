@@ -121,6 +121,11 @@ class S1d157xx
     };
 
     constexpr static auto NOPS = 1;
+    // Bytes on the bus needed to move the column pointer, gaps up to this length are cheaper to resend
+    constexpr static size_t COLUMN_SEED_COST = 2;
+
+    // Mirror of the visible controller GRAM, used to skip columns that are already up to date
+    static inline std::array<std::array<uint8_t, Disp::X_DIM>, Disp::PAGES> gram_{};
 
     constexpr static std::array init_seq{
       C_OSC_ENABLE,
@@ -169,6 +174,12 @@ class S1d157xx
         NopDelay<NOPS>();
         CsPin::Set();
     }
+
+    static void SetColumn(size_t column)
+    {
+        SendCommand(C_COLUMN_HIGH | (column >> 4));
+        SendCommand(C_COLUMN_LOW | (column & 0x0F));
+    }
 public:
     using Props = Disp;
 
@@ -176,11 +187,11 @@ public:
     {
         for(size_t page{}; page < Disp::PAGES; ++page) {
             SendCommand(C_PAGEADDRESS | page);
-            SendCommand(C_COLUMN_HIGH | (Disp::X_OFFSET >> 4));
-            SendCommand(C_COLUMN_LOW | (Disp::X_OFFSET & 0x0F));
+            SetColumn(Disp::X_OFFSET);
             for(size_t i = 0; i < Disp::X_DIM; ++i) {
                 SendData(0xFF);
             }
+            gram_[page].fill(0xFF);
         }
     }
 
@@ -188,12 +199,14 @@ public:
     {
         for(size_t page{}; page < Disp::PAGES_EXT; ++page) {
             SendCommand(C_PAGEADDRESS | page);
-            SendCommand(C_COLUMN_HIGH | (Disp::X_OFFSET_EXT >> 4));
-            SendCommand(C_COLUMN_LOW | (Disp::X_OFFSET_EXT & 0x0F));
+            SetColumn(Disp::X_OFFSET_EXT);
             for(size_t i = 0; i < Disp::X_EXT; ++i) {
                 SendData(0);
             }
         }
+        for(auto& page : gram_) {
+            page.fill(0);
+        }
     }
 
     static void Init()
@@ -206,20 +219,43 @@ public:
         Clear();
     }
 
-    static void PutPage(size_t x_start, size_t x_len, size_t y_page, uint8_t* buf)
+    /**
+     * @brief Transmit only the column runs that differ from the GRAM mirror.
+     * Short unchanged gaps inside a run are resent, as long as it's cheaper than re-seeding the column address.
+     */
+    static void PutPage(size_t x_start, size_t x_len, size_t y_page, const uint8_t* buf)
     {
+        if(x_start >= Disp::X_DIM || y_page >= Disp::PAGES) {
+            return;
+        }
         if(x_start + x_len >= Disp::X_DIM) {
             x_len = Disp::X_DIM - x_start;
         }
-        if(y_page >= Disp::PAGES) {
-            y_page = Disp::PAGES;
-        }
-        x_start += Disp::X_OFFSET;
-        SendCommand(C_PAGEADDRESS | y_page);
-        SendCommand(C_COLUMN_HIGH | (x_start >> 4));
-        SendCommand(C_COLUMN_LOW | (x_start & 0x0F));
-        for(size_t i{}; i < x_len; ++i) {
-            SendData(*buf++);
+        auto* shadow = &gram_[y_page][x_start];
+        bool pageSelected{};
+        size_t col{};
+        while(true) {
+            while(col < x_len && shadow[col] == buf[col]) {
+                ++col;
+            }
+            if(col == x_len) {
+                break;
+            }
+            auto last = col;
+            for(auto i = col + 1; i < x_len && i - last <= COLUMN_SEED_COST + 1; ++i) {
+                if(shadow[i] != buf[i]) {
+                    last = i;
+                }
+            }
+            if(!pageSelected) {
+                SendCommand(C_PAGEADDRESS | y_page);
+                pageSelected = true;
+            }
+            SetColumn(x_start + col + Disp::X_OFFSET);
+            for(; col <= last; ++col) {
+                shadow[col] = buf[col];
+                SendData(buf[col]);
+            }
         }
     }
 
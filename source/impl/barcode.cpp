@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "barcode.h"
+#include "buzzer.h"
+#include "config_store.h"
+#include "hal.h"
+#include "perfect_hash.h"
+#include "temp_control.h"
+#include <atomic>
+
+namespace Barcode {
+
+using Control::Cartridge;
+
+struct Tip
+{
+    std::string_view code; // Part number without the separators
+    Control::TipProfile profile;
+};
+
+// Starting values, the offsets are to be refined per tip with a tip thermometer.
+// Stored by the index: append only.
+static constexpr Utils::PerfectHashTable TIPS{std::array{
+  // clang-format off
+  Tip{"C245906", {Cartridge::T245, 4.0f, 0.030f, 0.020f, 0.004f, 130.0f}}, // Conical 0.6 mm
+  Tip{"C245907", {Cartridge::T245, 4.0f, 0.030f, 0.020f, 0.004f, 130.0f}}, // Chisel 1.6 mm
+  Tip{"C245903", {Cartridge::T245, 5.0f, 0.032f, 0.020f, 0.004f, 130.0f}}, // Chisel 2.2 mm
+  Tip{"C245112", {Cartridge::T245, 8.0f, 0.036f, 0.022f, 0.005f, 130.0f}}, // Bevel 3.2 mm
+  Tip{"C245116", {Cartridge::T245, 10.0f, 0.040f, 0.024f, 0.006f, 130.0f}}, // Chisel 5.2 mm
+  Tip{"C245731", {Cartridge::T245, 3.0f, 0.026f, 0.018f, 0.003f, 100.0f}}, // Conical 0.3 mm
+  Tip{"C210002", {Cartridge::C210, 1.0f, 0.013f, 0.009f, 0.001f, 50.0f}},  // Conical 0.1 mm
+  Tip{"C210007", {Cartridge::C210, 2.0f, 0.015f, 0.010f, 0.001f, 65.0f}},  // Chisel 0.8 mm
+  Tip{"C210018", {Cartridge::C210, 2.0f, 0.015f, 0.010f, 0.001f, 65.0f}},  // Bevel 1.2 mm
+  Tip{"C210019", {Cartridge::C210, 2.0f, 0.015f, 0.010f, 0.001f, 65.0f}},  // Chisel 1.5 mm
+  Tip{"C210020", {Cartridge::C210, 3.0f, 0.017f, 0.011f, 0.001f, 65.0f}},  // Chisel 2.0 mm
+  // clang-format on
+}};
+
+static std::atomic<uint8_t> selected;
+
+void SelectIron(Channel ch)
+{
+    selected = ch;
+}
+
+bool Apply(const char* code, size_t len)
+{
+    char key[16];
+    size_t keyLen{};
+    for(size_t i{}; i < len; ++i) {
+        auto c = code[i];
+        if(c >= 'a' && c <= 'z') {
+            c = char(c - 'a' + 'A');
+        }
+        if((c < 'A' || c > 'Z') && (c < '0' || c > '9')) {
+            continue;
+        }
+        if(keyLen == sizeof(key)) {
+            return false;
+        }
+        key[keyLen++] = c;
+    }
+    const auto* tip = TIPS.Find({key, keyLen});
+    if(!tip) {
+        return false;
+    }
+    // The cartridge type comes with the profile, a single call keeps the control step from seeing it apart
+    Control::SetTip(Channel(selected.load()), tip->profile, uint32_t(TIPS.IndexOf(tip) + 1));
+    return true;
+}
+
+#if BARCODE_SCANNER
+
+// The usual scanner factory setting
+constexpr uint32_t BAUDRATE = 9600;
+constexpr size_t RX_QUEUE_SIZE = 32;
+constexpr size_t MAX_CODE_LEN = 32;
+
+static uint8_t rxBuffer[RX_QUEUE_SIZE];
+static INPUTQUEUE_DECL(rxQueue, rxBuffer, RX_QUEUE_SIZE, nullptr, nullptr);
+
+static void RxChar(UARTDriver*, uint16_t c)
+{
+    chSysLockFromISR();
+    iqPutI(&rxQueue, uint8_t(c));
+    chSysUnlockFromISR();
+}
+
+static const UARTConfig uartConfig{
+  .rxchar_cb = RxChar,
+  .speed = BAUDRATE,
+  .cr1 = 0,
+  .cr2 = 0,
+  .cr3 = 0,
+};
+
+// A code ends with CR and/or LF, the usual scanner suffix
+static THD_WORKING_AREA(BARCODE_WA_SIZE, 384);
+static THD_FUNCTION(barcodeThread, )
+{
+    char code[MAX_CODE_LEN];
+    size_t len{};
+    while(true) {
+        auto c = iqGetTimeout(&rxQueue, TIME_INFINITE);
+        if(c != '\r' && c != '\n') {
+            if(len < sizeof(code)) {
+                code[len++] = char(c);
+            }
+            continue;
+        }
+        if(len) {
+            Drivers::Buzzer::Beep(Apply(code, len) ? Drivers::Buzzer::BuzType::SHORT : Drivers::Buzzer::BuzType::LONG);
+        }
+        len = 0;
+    }
+}
+
+#endif
+
+void init()
+{
+    for(uint32_t ch{}; ch < Drivers::Heater::CHANNELS_NUM; ++ch) {
+        // The cartridge type is already restored by the control
+        auto index = Config::Get(Config::Key(Config::TIP_1 + ch), 0);
+        const auto* tip = index > 0 ? TIPS.At(size_t(index - 1)) : nullptr;
+        if(tip) {
+            Control::SetTip(Channel(ch), tip->profile, uint32_t(index));
+        }
+    }
+#if BARCODE_SCANNER
+    uartStart(&UARTD1, &uartConfig);
+    auto* thd = chThdCreateStatic(BARCODE_WA_SIZE, sizeof(BARCODE_WA_SIZE), NORMALPRIO - 1, barcodeThread, nullptr);
+    chRegSetThreadNameX(thd, "barcode");
+#endif
+}
+
+} // Barcode
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BARCODE_H
+#define BARCODE_H
+
+#include "heater.h"
+#include <cstddef>
+
+#ifndef BARCODE_SCANNER
+#define BARCODE_SCANNER FALSE
+#endif
+
+/**
+ * Tip selection by the scanned part number, e.g. "C245-906". With BARCODE_SCANNER the USART1 port
+ * serves the scanner instead of the telemetry link, both can't share the baud rate.
+ */
+namespace Barcode {
+
+using Drivers::Heater::Channel;
+
+/**
+ * @brief Restore the stored tips, then start the scanner port and its thread if it's built in.
+ * The config store must be loaded.
+ */
+void init();
+
+/**
+ * @brief The iron the next scanned tip goes to
+ */
+void SelectIron(Channel ch);
+
+/**
+ * @brief Look the code up and apply the tip to the selected iron, the separators and the case are ignored
+ * @return false for an unknown code
+ */
+bool Apply(const char* code, size_t len);
+
+} // Barcode
+
+#endif // BARCODE_H
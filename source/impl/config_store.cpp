@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "config_store.h"
+#include "chlog.h"
+#include "config_log.h"
+#include "hal.h"
+#include "m24c64.h"
+
+namespace Config {
+
+using namespace Drivers;
+
+using Eeprom = M24c64<I2cBus<&I2CD1>>;
+// 64 pages give a quarter of a billion of page writes with 1M cycles endurance, and 2KiB to read at boot
+constexpr size_t LOG_PAGES = 64;
+constexpr auto FLUSH_DELAY = TIME_S2I(3);
+constexpr auto RETRY_DELAY = TIME_S2I(10);
+
+static Log<Eeprom, KEYS_NUM, LOG_PAGES> eepromLog;
+
+static std::array<value_t, KEYS_NUM> values;
+static uint64_t present;
+static Stats stats;
+
+static virtual_timer_t flushTimer;
+static BSEMAPHORE_DECL(flushRequest, true);
+
+static void flushTimerCallback(virtual_timer_t*, void*)
+{
+    chSysLockFromISR();
+    chBSemSignalI(&flushRequest);
+    chSysUnlockFromISR();
+}
+
+static Status LoadLog()
+{
+    return eepromLog.Load([](size_t key, value_t value) {
+        chSysLock();
+        // A value set since the start is newer than the stored one
+        if(!(present & (uint64_t{1} << key))) {
+            values[key] = value;
+            present |= uint64_t{1} << key;
+        }
+        chSysUnlock();
+    });
+}
+
+// Store() holds a page and the EEPROM write frame on top of the I2C driver and the saved context, about 300 bytes
+static THD_WORKING_AREA(FLUSH_WA_SIZE, 384);
+static THD_FUNCTION(configFlush, )
+{
+    while(true) {
+        chBSemWait(&flushRequest);
+        // Storing is refused until the log is loaded, the retries come here as well
+        auto result = eepromLog.IsLoaded() ? Status::Success : LoadLog();
+        if(result == Status::Success) {
+            chSysLock();
+            auto snapshot = values;
+            auto mask = present;
+            chSysUnlock();
+            result = eepromLog.Store(snapshot, mask);
+        }
+        auto logStats = eepromLog.GetStats();
+        chSysLock();
+        ++stats.flushes;
+        stats.pagesWritten = logStats.pagesWritten;
+        stats.corruptPages = logStats.corruptPages;
+        if(result != Status::Success) {
+            ++stats.failures;
+            if(!chVTIsArmedI(&flushTimer)) {
+                chVTSetI(&flushTimer, RETRY_DELAY, flushTimerCallback, nullptr);
+            }
+        }
+        chSysUnlock();
+        if(result != Status::Success) {
+            CHLOG("config: flush failed (%d), retrying", int(result));
+        }
+    }
+}
+
+void init()
+{
+    I2cBus<&I2CD1>::Init();
+    chVTObjectInit(&flushTimer);
+    if(LoadLog() != Status::Success) {
+        ++stats.failures;
+        // The flush thread loads it later, the defaults are in use until then
+        chVTSet(&flushTimer, RETRY_DELAY, flushTimerCallback, nullptr);
+    }
+    stats.corruptPages = eepromLog.GetStats().corruptPages;
+    auto* thd = chThdCreateStatic(FLUSH_WA_SIZE, sizeof(FLUSH_WA_SIZE), NORMALPRIO - 1, configFlush, nullptr);
+    chRegSetThreadNameX(thd, "config_flush");
+}
+
+value_t Get(Key key, value_t defaultValue)
+{
+    chSysLock();
+    auto result = (present & (uint64_t{1} << key)) ? values[key] : defaultValue;
+    chSysUnlock();
+    return result;
+}
+
+void Set(Key key, value_t value)
+{
+    chSysLock();
+    SetI(key, value);
+    chSysUnlock();
+}
+
+void SetI(Key key, value_t value)
+{
+    chDbgCheckClassI();
+    auto bit = uint64_t{1} << key;
+    // Restoring a state stores its values again, that mustn't cost a page write
+    if((present & bit) && values[key] == value) {
+        return;
+    }
+    values[key] = value;
+    present |= bit;
+    // Every change postpones the flush, a burst of changes ends up in one page write
+    chVTSetI(&flushTimer, FLUSH_DELAY, flushTimerCallback, nullptr);
+}
+
+Stats GetStats()
+{
+    chSysLock();
+    auto result = stats;
+    chSysUnlock();
+    return result;
+}
+
+} // Config
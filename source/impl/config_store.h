@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <cstdint>
+
+namespace Config {
+
+// Stored ids, append only: the values already in the EEPROM are bound to them
+enum Key : uint8_t {
+    BACKLIGHT_HUE,
+    SETPOINT_1,
+    SETPOINT_2,
+    SETPOINT_3,
+    CARTRIDGE_1,
+    CARTRIDGE_2,
+    CARTRIDGE_3,
+    PRESET_1,
+    PRESET_2,
+    PRESET_3,
+    TIP_1, // Tip table index + 1, zero for the cartridge defaults
+    TIP_2,
+    TIP_3,
+    KEYS_NUM
+};
+
+using value_t = int16_t;
+
+struct Stats
+{
+    uint32_t flushes;
+    uint32_t pagesWritten; // Each one is a write cycle of a single EEPROM page
+    uint32_t failures;
+    uint32_t corruptPages;
+};
+
+/**
+ * @brief Load the stored values and start the flush thread, the I2C1 bus is started if it isn't yet
+ */
+void init();
+
+value_t Get(Key key, value_t defaultValue);
+
+/**
+ * @brief Changes are collected in RAM and written in one batch when no more changes come for FLUSH_DELAY
+ */
+void Set(Key key, value_t value);
+
+/**
+ * @brief Set() from a locked state, to store several values together with the state they belong to
+ */
+void SetI(Key key, value_t value);
+Stats GetStats();
+
+} // Config
+
+#endif // CONFIG_STORE_H
@@ -20,18 +20,39 @@
  * SOFTWARE.
  */
 
+#include "barcode.h"
 #include "buzzer.h"
 #include "ch.h"
+#include "chlog.h"
+#include "config_store.h"
 #include "display_handler.h"
 #include "hal.h"
+#include "heater.h"
+#include "power_monitor.h"
+#include "profiler.h"
+#include "remote.h"
 #include "sensor_handler.h"
+#include "telemetry.h"
+#include "temp_control.h"
 
 int main()
 {
     halInit();
     chSysInit();
-    // Sensors::init();
-    sdStart(&SD1, NULL);
+#if !BARCODE_SCANNER
+    Telemetry::init();
+#endif
+    Config::init();
+    Control::init();
+    Barcode::init();
+    Drivers::Heater::Init();
+    Sensors::init();
+    PowerMonitor::init();
+    DeferredLog::init([](const DeferredLog::word_t* record, size_t words) {
+        return Telemetry::Send(Telemetry::FRAME_LOG, record, words * sizeof(*record));
+    });
+    Profiler::init();
+    Remote::init();
     Ui::Init();
     Drivers::Buzzer::Init();
     while(true) {
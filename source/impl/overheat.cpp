@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "overheat.h"
+#include "hal.h"
+#include <algorithm>
+
+namespace Overheat {
+
+using namespace Drivers;
+
+constexpr uint32_t AWD_BITS = ADC_CR1_AWDCH | ADC_CR1_AWDSGL | ADC_CR1_AWDEN | ADC_CR1_AWDIE;
+// The ADC runs from PCLK2 / 4, with ADC_SAMPLE_480 on every channel, see Sensors
+static_assert(STM32_ADC_ADCPRE == ADC_CCR_ADCPRE_DIV4);
+constexpr Timing TIMING{
+  .cpuHz = STM32_SYSCLK,
+  .adcHz = STM32_PCLK2 / 4,
+  .tickHz = Heater::TICK_FREQUENCY,
+  .periodTicks = Heater::PERIOD,
+  .triggerTicks = Heater::SAMPLING_TICKS,
+  .conversionClocks = 480 + 12,
+};
+// Thermocouple of a heater channel is at the same scan position
+static_assert(size_t(Sensors::TC1) == Heater::IRON_1 && size_t(Sensors::TC2) == Heater::IRON_2 &&
+              size_t(Sensors::TC3) == Heater::IRON_3);
+
+// Full scale never trips, it stays until the control sets the limit
+static volatile Sensors::sample_t limits[Heater::CHANNELS_NUM] = {Sensors::ADC_MAX, Sensors::ADC_MAX, Sensors::ADC_MAX};
+static size_t watched = Heater::CHANNELS_NUM;
+static Stats stats;
+
+static void StopWatchdog()
+{
+    ADCD1.adc->CR1 = ADCD1.adc->CR1 & ~AWD_BITS;
+}
+
+// The critical zone lengths bound the cutoff latency
+static_assert(CH_DBG_STATISTICS == TRUE);
+
+// Called from the ADC interrupt hook in mcuconf.h, only the kernel critical zones delay it
+extern "C" void overheatWatchdogHook()
+{
+    Heater::CutOffX();
+    auto now = chSysGetRealtimeCounterX();
+    StopWatchdog();
+    auto latency = LatencyCycles(TIMING, now, Heater::GetPeriodStampX(), watched);
+    ++stats.trips;
+    stats.channel = watched;
+    stats.latencyCycles = latency;
+    stats.latencyMaxCycles = std::max(stats.latencyMaxCycles, latency);
+}
+
+void SetLimit(Channel ch, Sensors::sample_t counts)
+{
+    limits[ch] = counts;
+}
+
+void WatchNextI()
+{
+    StopWatchdog();
+    if(Heater::IsCutOff()) {
+        return;
+    }
+    uint32_t heatingMask{};
+    for(uint32_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        heatingMask |= Heater::IsHeatingI(Channel(ch)) << ch;
+    }
+    watched = NextWatched(watched, heatingMask);
+    if(watched == Heater::CHANNELS_NUM) {
+        return;
+    }
+    // The input number is taken back from the scan sequence
+    auto input = (ADCD1.adc->SQR3 >> (5 * watched)) & ADC_CR1_AWDCH;
+    ADCD1.adc->HTR = limits[watched];
+    ADCD1.adc->LTR = 0;
+    ADCD1.adc->CR1 = ADCD1.adc->CR1 | ADC_CR1_AWDSGL | ADC_CR1_AWDEN | ADC_CR1_AWDIE | input;
+}
+
+Stats GetStats()
+{
+    chSysLock();
+    auto result = stats;
+    const auto& kernel = currcore->kernel_stats;
+    result.criticalMaxCycles = std::max(kernel.m_crit_thd.worst, kernel.m_crit_isr.worst);
+    chSysUnlock();
+    result.latencyBoundCycles = result.latencyMaxCycles + result.criticalMaxCycles;
+    return result;
+}
+
+} // Overheat
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OVERHEAT_H
+#define OVERHEAT_H
+
+#include "heater.h"
+#include "sensor_handler.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Last line over-temperature protection on the ADC analog watchdog, it doesn't wait for any thread.
+ * The watchdog takes one channel, so it moves over the heating thermocouple channels block by block.
+ * A conversion above the limit cuts all the heaters off from the ADC interrupt.
+ * The vector is shared with the ChibiOS ADC driver, so the interrupt is a kernel aware one: priority 3
+ * is above the other interrupts, but the kernel critical zones hold it off. The worst case is the
+ * interrupt path plus the longest critical zone, both are reported in Stats.
+ */
+namespace Overheat {
+
+using Drivers::Heater::Channel;
+
+// Above any setpoint, the control keeps the limits of the channels in the raw counts
+constexpr float CUTOFF_CELSIUS = 480.0f;
+
+struct Stats
+{
+    uint32_t trips;
+    uint32_t channel;            // Watched at the last trip
+    uint32_t latencyCycles;      // From the end of the conversion above the limit to the heaters off, last trip
+    uint32_t latencyMaxCycles;   // Over the trips since the start
+    uint32_t criticalMaxCycles;  // Longest kernel critical zone since the start, a trip may wait for it to end
+    uint32_t latencyBoundCycles; // The slowest trip plus the longest critical zone
+};
+
+// The hardware independent part of the interrupt path, the host model runs it as is
+
+struct Timing
+{
+    uint32_t cpuHz;
+    uint32_t adcHz;
+    uint32_t tickHz;
+    uint32_t periodTicks;
+    uint32_t triggerTicks;     // TC conversions start after the period start
+    uint32_t conversionClocks; // Sampling and conversion of a channel
+};
+
+/**
+ * @brief Round robin over the heating channels after the current one, CHANNELS_NUM when none heats
+ */
+constexpr size_t NextWatched(size_t current, uint32_t heatingMask)
+{
+    for(size_t i{1}; i <= Drivers::Heater::CHANNELS_NUM; ++i) {
+        auto ch = (current + i) % Drivers::Heater::CHANNELS_NUM;
+        if(heatingMask & (1U << ch)) {
+            return ch;
+        }
+    }
+    return Drivers::Heater::CHANNELS_NUM;
+}
+
+/**
+ * @brief End of the conversion at the scan position, CPU cycles from the period start
+ */
+constexpr uint32_t FaultOffsetCycles(const Timing& timing, size_t position)
+{
+    return timing.triggerTicks * (timing.cpuHz / timing.tickHz) +
+           uint32_t(position + 1) * timing.conversionClocks * (timing.cpuHz / timing.adcHz);
+}
+
+/**
+ * @brief Fault to cutoff time, the period interrupt may have come in between and moved the stamp
+ */
+constexpr uint32_t LatencyCycles(const Timing& timing, uint32_t now, uint32_t periodStamp, size_t position)
+{
+    auto elapsed = now - periodStamp;
+    auto offset = FaultOffsetCycles(timing, position);
+    if(elapsed < offset) {
+        elapsed += timing.periodTicks * (timing.cpuHz / timing.tickHz);
+    }
+    return elapsed - offset;
+}
+
+/**
+ * @brief Limit of the channel in the raw ADC counts, taken on the next turn of the channel
+ */
+void SetLimit(Channel ch, Sensors::sample_t counts);
+
+/**
+ * @brief Move the watchdog to the next heating channel, called at the block end from the ADC DMA callback
+ */
+void WatchNextI();
+Stats GetStats();
+
+} // Overheat
+
+#endif // OVERHEAT_H
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "power_monitor.h"
+#include "chlog.h"
+#include "ina3221.h"
+
+namespace PowerMonitor {
+
+using namespace Drivers;
+
+using Bus = I2cBus<&I2CD1>;
+using Monitor = Ina3221<Bus>;
+
+// INA3221 channels 1..3 measure the IRON_1..3 supplies
+constexpr float SHUNT_OHMS = 0.01f;
+// The shunt conversion spans more than one heater period, which keeps the PWM ripple in the average low
+constexpr auto SHUNT_CT = Monitor::CT_8244US;
+constexpr auto BUS_CT = Monitor::CT_1100US;
+constexpr auto AVERAGING = Monitor::AVG_4;
+// A full cycle takes 3 * 4 * (8.244 + 1.1) ms, the flag is polled a few times faster
+constexpr auto POLL_INTERVAL = TIME_MS2I(20);
+constexpr auto RETRY_INTERVAL = TIME_MS2I(500);
+
+static std::optional<Reading> readings[Heater::CHANNELS_NUM];
+static Stats stats;
+
+static void Publish(const Monitor::Results& results)
+{
+    Reading converted[Heater::CHANNELS_NUM];
+    for(size_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        float volts = Monitor::BusMillivolts(results[ch]) * 1e-3f;
+        float amps = Monitor::ShuntMicrovolts(results[ch]) * 1e-6f / SHUNT_OHMS;
+        converted[ch] = {.volts = volts, .amps = amps, .watts = volts * amps};
+    }
+    chSysLock();
+    for(size_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        readings[ch] = converted[ch];
+    }
+    ++stats.conversions;
+    chSysUnlock();
+}
+
+static void Invalidate()
+{
+    chSysLock();
+    for(auto& reading : readings) {
+        reading.reset();
+    }
+    ++stats.errors;
+    chSysUnlock();
+}
+
+static THD_WORKING_AREA(MONITOR_WA_SIZE, 256);
+static THD_FUNCTION(powerMonitor, )
+{
+    Bus::Init();
+    while(true) {
+        while(Monitor::Init(AVERAGING, BUS_CT, SHUNT_CT) != Status::Success) {
+            Invalidate();
+            chThdSleep(RETRY_INTERVAL);
+        }
+        while(true) {
+            chThdSleep(POLL_INTERVAL);
+            bool ready;
+            Monitor::Results results;
+            if(Monitor::PollConversionReady(ready) != Status::Success ||
+               (ready && Monitor::Read(results) != Status::Success)) {
+                CHLOG("power monitor: bus error, restarting");
+                Invalidate();
+                break;
+            }
+            if(ready) {
+                Publish(results);
+            }
+        }
+    }
+}
+
+void init()
+{
+    auto* thd = chThdCreateStatic(MONITOR_WA_SIZE, sizeof(MONITOR_WA_SIZE), NORMALPRIO, powerMonitor, nullptr);
+    chRegSetThreadNameX(thd, "power_monitor");
+}
+
+std::optional<Reading> GetReading(Channel ch)
+{
+    chSysLock();
+    auto result = readings[ch];
+    chSysUnlock();
+    return result;
+}
+
+Stats GetStats()
+{
+    chSysLock();
+    auto result = stats;
+    chSysUnlock();
+    return result;
+}
+
+} // PowerMonitor
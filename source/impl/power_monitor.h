@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef POWER_MONITOR_H
+#define POWER_MONITOR_H
+
+#include "heater.h"
+#include <cstdint>
+#include <optional>
+
+namespace PowerMonitor {
+
+using Drivers::Heater::Channel;
+
+struct Reading
+{
+    float volts;
+    float amps;
+    float watts; // Averaged over the conversion time, so it is the real heater power at the present duty
+};
+
+struct Stats
+{
+    uint32_t conversions;
+    uint32_t errors; // Failed I2C transfers, the device is re-initialized after each one
+};
+
+/**
+ * @brief Start the INA3221 polling thread, the I2C1 bus is started if it isn't yet
+ */
+void init();
+
+/**
+ * @brief The latest conversion of the iron supply, empty until the device is up or after a bus failure
+ */
+std::optional<Reading> GetReading(Channel ch);
+Stats GetStats();
+
+} // PowerMonitor
+
+#endif // POWER_MONITOR_H
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "power_scheduler.h"
+#include <algorithm>
+
+namespace Power {
+
+using namespace Drivers;
+
+static float Grant(const Demands& demands, bool inUse, float budget, std::array<float, Heater::CHANNELS_NUM>& duties)
+{
+    float requested{};
+    for(const auto& demand : demands) {
+        if(demand.inUse == inUse) {
+            requested += demand.duty * demand.fullPower;
+        }
+    }
+    float scale = requested > budget ? budget / requested : 1.0f;
+    for(size_t ch{}; ch < demands.size(); ++ch) {
+        if(demands[ch].inUse == inUse) {
+            duties[ch] = demands[ch].duty * scale;
+        }
+    }
+    return std::max(budget - requested * scale, 0.0f);
+}
+
+// A pulse already in the period, the load of the supply changes at its edges only
+struct Pulse
+{
+    uint32_t start;
+    uint32_t end;
+    float watts;
+};
+
+using Pulses = std::array<Pulse, Heater::CHANNELS_NUM>;
+
+static float LoadAt(const Pulses& pulses, size_t count, uint32_t tick)
+{
+    float load{};
+    for(size_t i{}; i < count; ++i) {
+        if(pulses[i].start <= tick && tick < pulses[i].end) {
+            load += pulses[i].watts;
+        }
+    }
+    return load;
+}
+
+// The load rises at the pulse starts only, so the highest one is at the start of the range or at one of those
+static float PeakLoad(const Pulses& pulses, size_t count, uint32_t start, uint32_t end)
+{
+    float peak = LoadAt(pulses, count, start);
+    for(size_t i{}; i < count; ++i) {
+        if(pulses[i].start > start && pulses[i].start < end) {
+            peak = std::max(peak, LoadAt(pulses, count, pulses[i].start));
+        }
+    }
+    return peak;
+}
+
+/**
+ * @brief Where the pulse goes with the lowest peak, the earliest of the equal ones. A pulse that fits somewhere
+ * also fits moved back to the period start or to the end of a pulse, those and their mirrors are the candidates.
+ * @return false when the pulse can't be placed whole within the budget
+ */
+static bool Place(const Pulses& pulses, size_t count, uint32_t ticks, float watts, uint32_t maxTicks, uint32_t& start)
+{
+    std::array<uint32_t, 2 + 2 * Heater::CHANNELS_NUM> candidates{0, maxTicks - ticks};
+    size_t candidatesNum = 2;
+    for(size_t i{}; i < count; ++i) {
+        if(pulses[i].end + ticks <= maxTicks) {
+            candidates[candidatesNum++] = pulses[i].end;
+        }
+        if(pulses[i].start >= ticks) {
+            candidates[candidatesNum++] = pulses[i].start - ticks;
+        }
+    }
+    bool found{};
+    float best{};
+    for(size_t i{}; i < candidatesNum; ++i) {
+        auto candidate = candidates[i];
+        auto peak = PeakLoad(pulses, count, candidate, candidate + ticks);
+        if(peak + watts > BUDGET_WATTS) {
+            continue;
+        }
+        if(!found || peak < best || (peak == best && candidate < start)) {
+            found = true;
+            best = peak;
+            start = candidate;
+        }
+    }
+    return found;
+}
+
+// The longest run of ticks with room for the pulse, the loads are constant between the pulse edges
+static uint32_t LongestRoom(const Pulses& pulses, size_t count, float watts, uint32_t maxTicks, uint32_t& start)
+{
+    std::array<uint32_t, 2 + 2 * Heater::CHANNELS_NUM> edges{0, maxTicks};
+    size_t edgesNum = 2;
+    for(size_t i{}; i < count; ++i) {
+        edges[edgesNum++] = pulses[i].start;
+        edges[edgesNum++] = pulses[i].end;
+    }
+    std::sort(edges.begin(), edges.begin() + edgesNum);
+    uint32_t longest{}, runStart{};
+    bool inRun{};
+    for(size_t i{}; i + 1 < edgesNum; ++i) {
+        if(edges[i] == edges[i + 1]) {
+            continue;
+        }
+        if(LoadAt(pulses, count, edges[i]) + watts > BUDGET_WATTS) {
+            inRun = false;
+            continue;
+        }
+        if(!inRun) {
+            runStart = edges[i];
+            inRun = true;
+        }
+        if(edges[i + 1] - runStart > longest) {
+            longest = edges[i + 1] - runStart;
+            start = runStart;
+        }
+    }
+    return longest;
+}
+
+Slots Schedule(const Demands& demands, uint32_t maxTicks)
+{
+    std::array<float, Heater::CHANNELS_NUM> duties{};
+    float budget = Grant(demands, true, BUDGET_WATTS, duties);
+    Grant(demands, false, budget, duties);
+
+    // Priority order: in use first, then the longer pulses, they are harder to fit
+    std::array<uint8_t, Heater::CHANNELS_NUM> order;
+    for(size_t ch{}; ch < order.size(); ++ch) {
+        order[ch] = uint8_t(ch);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint8_t a, uint8_t b) {
+        if(demands[a].inUse != demands[b].inUse) {
+            return demands[a].inUse;
+        }
+        return duties[a] > duties[b];
+    });
+
+    Slots slots{};
+    Pulses pulses;
+    size_t count{};
+    for(auto ch : order) {
+        uint32_t ticks = std::min(uint32_t(std::clamp(duties[ch], 0.0f, 1.0f) * maxTicks), maxTicks);
+        auto watts = demands[ch].fullPower;
+        uint32_t start{};
+        // What doesn't fit whole is cut to the longest room left, the overflow waits for the next periods
+        if(!ticks || (!Place(pulses, count, ticks, watts, maxTicks, start) &&
+                      !(ticks = LongestRoom(pulses, count, watts, maxTicks, start)))) {
+            continue;
+        }
+        slots[ch] = {start, ticks};
+        pulses[count++] = {start, start + ticks, watts};
+    }
+    return slots;
+}
+
+} // Power
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef POWER_SCHEDULER_H
+#define POWER_SCHEDULER_H
+
+#include "heater.h"
+#include <array>
+
+namespace Power {
+
+// LRS-350-24 is rated for 350W, keep a margin for the logic and the supply tolerance
+constexpr float BUDGET_WATTS = 320.0f;
+
+struct Demand
+{
+    float duty;      // Requested fraction of the maximum on-time
+    float fullPower; // Heater power at 100% duty and the present supply voltage
+    bool inUse;      // The iron is out of the stand, served before the stand-by ones
+};
+
+struct Slot
+{
+    uint32_t start; // Ticks from the earliest switch on point
+    uint32_t ticks;
+};
+
+using Demands = std::array<Demand, Drivers::Heater::CHANNELS_NUM>;
+using Slots = std::array<Slot, Drivers::Heater::CHANNELS_NUM>;
+
+/**
+ * @brief Split the power budget between the irons and place their on-times within the period.
+ * The irons in use get the budget first, then the rest is shared by the stand-by ones; inside a group
+ * the demands are scaled down proportionally. The on-times are staggered so the sum of the full powers stays
+ * within the budget at any tick, the priority ones placed first; a pulse which doesn't fit whole is cut
+ * to the longest room left, the rest of its duty waits for the next periods.
+ * @param maxTicks the length of the on-region, Heater::GetMaxDuty()
+ */
+Slots Schedule(const Demands& demands, uint32_t maxTicks);
+
+} // Power
+
+#endif // POWER_SCHEDULER_H
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "profiler.h"
+#include "chlog.h"
+#include "display_handler.h"
+#include "overheat.h"
+#include "sensor_handler.h"
+#include "telemetry.h"
+#include <algorithm>
+
+// ISR time, the nested ones are accounted within the outermost
+static uint32_t irqNesting;
+static rtcnt_t irqStart;
+static rttime_t irqCycles;
+static uint32_t irqCount;
+
+extern "C" void profIrqEnter(void)
+{
+    if(irqNesting++ == 0) {
+        irqStart = chSysGetRealtimeCounterX();
+        ++irqCount;
+    }
+}
+
+extern "C" void profIrqExit(void)
+{
+    if(--irqNesting == 0) {
+        irqCycles += rtcnt_t(chSysGetRealtimeCounterX() - irqStart);
+    }
+}
+
+namespace Profiler {
+
+constexpr size_t MAX_THREADS = 16;
+constexpr char REPORT_REQUEST = 'p';
+constexpr char BENCHMARK_REQUEST = 'b';
+constexpr uint32_t BENCHMARK_FRAMES = 100;
+
+struct ThreadSample
+{
+    const thread_t* thread;
+    rttime_t cycles;
+};
+
+static ThreadSample lastSamples[MAX_THREADS];
+static rttime_t lastIrqCycles;
+static uint32_t lastIrqCount;
+static systime_t lastReport;
+
+// Untouched part of the working area, filled by the kernel at the thread creation
+static size_t StackFree(thread_t* tp)
+{
+    auto* base = reinterpret_cast<const uint8_t*>(chThdGetWorkingAreaX(tp));
+    auto* limit = reinterpret_cast<const uint8_t*>(tp);
+    size_t result{};
+    while(&base[result] < limit && base[result] == CH_DBG_STACK_FILL_VALUE) {
+        ++result;
+    }
+    return result;
+}
+
+static rttime_t LastCycles(const thread_t* tp)
+{
+    for(const auto& sample : lastSamples) {
+        if(sample.thread == tp) {
+            return sample.cycles;
+        }
+    }
+    return 0;
+}
+
+static void PrintPermille(BaseSequentialStream* out, rttime_t part, rttime_t total)
+{
+    auto permille = uint32_t(total ? part * 1000 / total : 0);
+    chprintf(out, "%3u.%u%%", permille / 10, permille % 10);
+}
+
+void Report(BaseSequentialStream* out)
+{
+    struct Row
+    {
+        const char* name;
+        rttime_t cycles;
+        uint32_t stackFree;
+    };
+    // Too big for the console stack, only the console thread reports
+    static Row rows[MAX_THREADS];
+    static ThreadSample samples[MAX_THREADS];
+    size_t count{};
+    rttime_t total{};
+    for(auto* tp = chRegFirstThread(); tp; tp = chRegNextThread(tp)) {
+        if(count == MAX_THREADS) {
+            continue;
+        }
+        chSysLock();
+        auto cycles = tp->stats.cumulative;
+        chSysUnlock();
+        auto* name = chRegGetThreadNameX(tp);
+        rows[count] = {name ? name : "?", cycles - LastCycles(tp), uint32_t(StackFree(tp))};
+        samples[count] = {tp, cycles};
+        total += rows[count].cycles;
+        ++count;
+    }
+    chSysLock();
+    auto isr = irqCycles - lastIrqCycles;
+    auto isrCount = irqCount - lastIrqCount;
+    lastIrqCycles = irqCycles;
+    lastIrqCount = irqCount;
+    chSysUnlock();
+    std::fill(std::begin(samples) + count, std::end(samples), ThreadSample{});
+    std::copy(std::begin(samples), std::end(samples), std::begin(lastSamples));
+    auto now = chVTGetSystemTime();
+    auto period = TIME_I2MS(chTimeDiffX(lastReport, now));
+    lastReport = now;
+
+    chprintf(out, "-- %u ms\r\n%-16s %7s %6s\r\n", uint32_t(period), "thread", "cpu", "stack");
+    for(size_t i{}; i < count; ++i) {
+        chprintf(out, "%-16s ", rows[i].name);
+        PrintPermille(out, rows[i].cycles, total);
+        chprintf(out, " %6u\r\n", rows[i].stackFree);
+    }
+    chprintf(out, "%-16s ", "irq");
+    PrintPermille(out, isr, total);
+    chprintf(out, " %6u\r\n", isrCount);
+    auto sensors = Sensors::GetStats();
+    chprintf(out,
+             "control: latency %u us, process %u us, overruns %u\r\n",
+             sensors.latencyMaxUs,
+             sensors.processMaxUs,
+             sensors.overruns);
+    auto filters = Sensors::GetFilterStats();
+    chprintf(out,
+             "filters: tc %u/%u, vin %u/%u/%u cycles\r\n",
+             filters.tcCycles[0],
+             filters.tcCycles[1],
+             filters.vinCycles[0],
+             filters.vinCycles[1],
+             filters.vinCycles[2]);
+    auto overheat = Overheat::GetStats();
+    chprintf(out,
+             "overheat: trips %u, channel %u, latency %u/%u cycles, critical zones %u, bound %u cycles\r\n",
+             overheat.trips,
+             overheat.channel,
+             overheat.latencyCycles,
+             overheat.latencyMaxCycles,
+             overheat.criticalMaxCycles,
+             overheat.latencyBoundCycles);
+    auto frames = Ui::GetFrameStats();
+    chprintf(out,
+             "display: frames %u, skipped %u, render %u/%u cycles\r\n",
+             frames.rendered,
+             frames.skipped,
+             frames.renderCycles,
+             frames.renderCyclesMax);
+    auto link = Telemetry::GetStats();
+    chprintf(out, "telemetry: frames %u, dropped %u\r\n", link.frames, link.dropped);
+    auto log = DeferredLog::GetStats();
+    chprintf(out, "log: records %u, dropped %u, unbound %u\r\n", log.records, log.dropped, log.unbound);
+}
+
+static THD_WORKING_AREA(CONSOLE_WA_SIZE, 512);
+static THD_FUNCTION(profilerConsole, )
+{
+    auto* stream = Telemetry::OpenConsole();
+    while(true) {
+        auto request = streamGet(stream);
+        if(request == REPORT_REQUEST) {
+            Report(stream);
+        }
+        else if(request == BENCHMARK_REQUEST) {
+            Ui::RunBenchmark(BENCHMARK_FRAMES);
+            auto frames = Ui::GetFrameStats();
+            chprintf(stream,
+                     "display benchmark: %u frames, %u cycles a frame\r\n",
+                     frames.benchmarkFrames,
+                     frames.benchmarkCycles);
+        }
+    }
+}
+
+void init()
+{
+    lastReport = chVTGetSystemTime();
+    auto* thd = chThdCreateStatic(CONSOLE_WA_SIZE, sizeof(CONSOLE_WA_SIZE), LOWPRIO, profilerConsole, nullptr);
+    chRegSetThreadNameX(thd, "profiler");
+}
+
+} // Profiler
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "hal.h"
+
+namespace Profiler {
+
+/**
+ * @brief Start the console thread, it prints the report when 'p' comes over the telemetry link, the cost of
+ * the whole screen redrawn a hundred times on 'b'.
+ * With BARCODE_SCANNER the link isn't started and there is no other free port, so the console
+ * gets no input and its output is dropped. Report() can still be called on another stream.
+ */
+void init();
+
+/**
+ * @brief Per thread CPU load and ISR time since the previous report, stack high-water marks,
+ * control loop and display timings
+ */
+void Report(BaseSequentialStream* out);
+
+} // Profiler
+
+#endif // PROFILER_H
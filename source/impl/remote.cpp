@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "remote.h"
+#include "config_store.h"
+#include "frame.h"
+#include "hal.h"
+#include "power_monitor.h"
+#include "sensor_handler.h"
+#include "telemetry.h"
+#include "temp_control.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Remote {
+
+using Drivers::Heater::Channel;
+
+// The CH9141 factory setting
+constexpr uint32_t BAUDRATE = 115'200;
+constexpr size_t MAX_PAYLOAD = sizeof(Telemetry::Sample);
+constexpr size_t FRAME_SIZE = Utils::MaxFrameSize(MAX_PAYLOAD);
+constexpr size_t PRESETS_NUM = 3;
+constexpr Config::value_t PRESET_DEFAULTS[PRESETS_NUM] = {280, 320, 350};
+// Keeps the sample stream within the BLE throughput
+constexpr uint16_t MIN_PERIOD_MS = 20;
+static_assert(REMOTE_PIN >= 0 && REMOTE_PIN <= 0xFFFF);
+
+static const SerialConfig serialConfig{BAUDRATE, 0, 0, 0};
+
+static uint8_t rxFrame[FRAME_SIZE];
+static uint8_t txFrame[FRAME_SIZE];
+static uint8_t reply[MAX_PAYLOAD + 1];
+static size_t replyLen;
+static size_t rxLen;
+static bool rxOverflow;
+static sysinterval_t samplePeriod;
+static uint8_t notifySeq;
+static Stats stats;
+
+// Only the request thread touches the unlock state
+static bool unlocked;
+static systime_t lastRequest;
+static uint32_t failedAttempts;
+static systime_t lockoutStart;
+
+static void Send(uint8_t type, uint8_t seq, const void* payload, size_t len)
+{
+    auto encoded = Utils::EncodeFrame(txFrame, sizeof(txFrame), type, seq, payload, len);
+    sdWrite(&SD6, txFrame, encoded);
+}
+
+static void Append(const void* data, size_t len)
+{
+    std::memcpy(&reply[replyLen], data, len);
+    replyLen += len;
+}
+
+static int16_t Get16(const uint8_t* p)
+{
+    return int16_t(p[0] | p[1] << 8);
+}
+
+static StatsReply CollectStats()
+{
+    auto sensors = Sensors::GetStats();
+    auto power = PowerMonitor::GetStats();
+    auto config = Config::GetStats();
+    auto link = Telemetry::GetStats();
+    chSysLock();
+    auto remote = stats;
+    chSysUnlock();
+    return {
+      .sensorBlocks = sensors.blocks,
+      .sensorOverruns = sensors.overruns,
+      .sensorErrors = sensors.errors,
+      .controlLatencyMaxUs = sensors.latencyMaxUs,
+      .controlProcessMaxUs = sensors.processMaxUs,
+      .powerConversions = power.conversions,
+      .powerErrors = power.errors,
+      .configFlushes = config.flushes,
+      .configFailures = config.failures,
+      .telemetryFrames = link.frames,
+      .telemetryDropped = link.dropped,
+      .remoteRequests = remote.requests,
+      .remoteErrors = remote.errors,
+    };
+}
+
+static void CountRefused()
+{
+    chSysLock();
+    ++stats.refused;
+    chSysUnlock();
+}
+
+static Result Unlock(uint16_t pin)
+{
+    auto now = chVTGetSystemTime();
+    if(failedAttempts >= UNLOCK_ATTEMPTS) {
+        if(chTimeDiffX(lockoutStart, now) < TIME_MS2I(UNLOCK_LOCKOUT_MS)) {
+            CountRefused();
+            return RESULT_LOCKED;
+        }
+        failedAttempts = 0;
+    }
+    if(REMOTE_PIN == 0 || pin != REMOTE_PIN) {
+        CountRefused();
+        if(++failedAttempts == UNLOCK_ATTEMPTS) {
+            lockoutStart = now;
+        }
+        return RESULT_BAD_ARGUMENT;
+    }
+    failedAttempts = 0;
+    unlocked = true;
+    return RESULT_OK;
+}
+
+// Arguments are read right from the decoded receive buffer, the reply data is appended after the result
+static Result Execute(const Utils::FrameView& request)
+{
+    const auto* args = request.payload;
+    auto hasChannel = request.len >= 1 && args[0] < Drivers::Heater::CHANNELS_NUM;
+    auto now = chVTGetSystemTime();
+    unlocked = unlocked && chTimeDiffX(lastRequest, now) < TIME_MS2I(UNLOCK_IDLE_MS);
+    lastRequest = now;
+    if(!unlocked && (request.type == CMD_SET_SETPOINT || request.type == CMD_SELECT_PRESET)) {
+        CountRefused();
+        return RESULT_LOCKED;
+    }
+    switch(request.type) {
+        case CMD_PING:
+            Append(&PROTOCOL_VERSION, sizeof(PROTOCOL_VERSION));
+            return RESULT_OK;
+        case CMD_GET_STATUS: {
+            if(!hasChannel) {
+                return RESULT_BAD_ARGUMENT;
+            }
+            auto status = Control::GetStatus(Channel(args[0]));
+            Append(&status.temperature, sizeof(float));
+            Append(&status.setpoint, sizeof(float));
+            Append(&status.duty, sizeof(float));
+            uint8_t cutOff = status.cutOff;
+            Append(&cutOff, sizeof(cutOff));
+            return RESULT_OK;
+        }
+        case CMD_SET_SETPOINT: {
+            if(!hasChannel || request.len < 3) {
+                return RESULT_BAD_ARGUMENT;
+            }
+            auto celsius = Get16(&args[1]);
+            if(celsius < 0 || celsius > Control::MAX_SETPOINT) {
+                return RESULT_BAD_ARGUMENT;
+            }
+            Control::SetSetpoint(Channel(args[0]), celsius);
+            return RESULT_OK;
+        }
+        case CMD_SELECT_PRESET: {
+            if(!hasChannel || request.len < 2 || args[1] >= PRESETS_NUM) {
+                return RESULT_BAD_ARGUMENT;
+            }
+            auto celsius = Config::Get(Config::Key(Config::PRESET_1 + args[1]), PRESET_DEFAULTS[args[1]]);
+            Control::SetSetpoint(Channel(args[0]), celsius);
+            return RESULT_OK;
+        }
+        case CMD_READ_STATS: {
+            auto result = CollectStats();
+            Append(&result, sizeof(result));
+            return RESULT_OK;
+        }
+        case CMD_SUBSCRIBE: {
+            if(request.len < 2) {
+                return RESULT_BAD_ARGUMENT;
+            }
+            auto period = uint16_t(Get16(args));
+            samplePeriod = period ? TIME_MS2I(std::max(period, MIN_PERIOD_MS)) : 0;
+            return RESULT_OK;
+        }
+        case CMD_UNLOCK:
+            if(request.len < 2) {
+                return RESULT_BAD_ARGUMENT;
+            }
+            return Unlock(uint16_t(Get16(args)));
+        default:
+            return RESULT_UNKNOWN_COMMAND;
+    }
+}
+
+static void Handle(size_t len)
+{
+    auto request = Utils::DecodeFrame(rxFrame, len);
+    chSysLock();
+    if(request) {
+        ++stats.requests;
+    }
+    else {
+        ++stats.errors;
+    }
+    chSysUnlock();
+    if(!request) {
+        return;
+    }
+    replyLen = 1;
+    reply[0] = Execute(*request);
+    Send(request->type | RESPONSE, request->seq, reply, replyLen);
+}
+
+void Receive(uint8_t c)
+{
+    if(c) {
+        rxOverflow |= rxLen == sizeof(rxFrame);
+        if(!rxOverflow) {
+            rxFrame[rxLen++] = c;
+        }
+        return;
+    }
+    if(rxOverflow) {
+        chSysLock();
+        ++stats.errors;
+        chSysUnlock();
+    }
+    else if(rxLen) {
+        Handle(rxLen);
+    }
+    rxLen = 0;
+    rxOverflow = false;
+}
+
+static THD_WORKING_AREA(REMOTE_WA_SIZE, 768);
+static THD_FUNCTION(remoteThread, )
+{
+    auto lastSample = chVTGetSystemTime();
+    while(true) {
+        sysinterval_t timeout = TIME_INFINITE;
+        if(samplePeriod) {
+            auto elapsed = chTimeDiffX(lastSample, chVTGetSystemTime());
+            if(elapsed >= samplePeriod) {
+                auto sample = Telemetry::Collect();
+                Send(NOTIFY_SAMPLE, notifySeq++, &sample, sizeof(sample));
+                lastSample = chVTGetSystemTime();
+                elapsed = 0;
+            }
+            timeout = samplePeriod - elapsed;
+        }
+        auto c = sdGetTimeout(&SD6, timeout);
+        if(c >= MSG_OK) {
+            Receive(uint8_t(c));
+        }
+    }
+}
+
+void init()
+{
+    sdStart(&SD6, &serialConfig);
+    auto* thd = chThdCreateStatic(REMOTE_WA_SIZE, sizeof(REMOTE_WA_SIZE), NORMALPRIO - 1, remoteThread, nullptr);
+    chRegSetThreadNameX(thd, "remote");
+}
+
+Stats GetStats()
+{
+    chSysLock();
+    auto result = stats;
+    chSysUnlock();
+    return result;
+}
+
+} // Remote
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef REMOTE_H
+#define REMOTE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef REMOTE_PIN
+#define REMOTE_PIN 0
+#endif
+
+/**
+ * Command/response protocol over the CH9141 BLE module on USART6, framed like the telemetry link.
+ * A request is sent as a frame of the command type, the response echoes the sequence number
+ * in a frame of the command type | RESPONSE, the payload starts with the Result.
+ * All the values are little-endian.
+ * Any peer in range may connect, so the commands changing the setpoints answer RESULT_LOCKED until
+ * CMD_UNLOCK is sent with REMOTE_PIN. The module is transparent and doesn't tell a disconnect,
+ * the unlock lapses after UNLOCK_IDLE without requests instead. Without REMOTE_PIN it never succeeds.
+ */
+namespace Remote {
+
+enum Command : uint8_t {
+    CMD_PING = 1,      // -> version(1)
+    CMD_GET_STATUS,    // ch(1) -> temperature, setpoint, duty (float), cutOff(1)
+    CMD_SET_SETPOINT,  // ch(1) celsius(int16), zero turns the iron off
+    CMD_SELECT_PRESET, // ch(1) preset(1), the setpoint is set to the stored preset temperature
+    CMD_READ_STATS,    // -> StatsReply
+    CMD_SUBSCRIBE,     // periodMs(uint16), zero stops -> NOTIFY_SAMPLE frames carrying Telemetry::Sample
+    CMD_UNLOCK,        // pin(uint16), refused for UNLOCK_LOCKOUT after UNLOCK_ATTEMPTS wrong ones
+};
+
+constexpr uint8_t RESPONSE = 0x80;
+constexpr uint8_t NOTIFY_SAMPLE = 0x40;
+constexpr uint8_t PROTOCOL_VERSION = 3;
+
+constexpr uint32_t UNLOCK_IDLE_MS = 60'000;
+constexpr uint32_t UNLOCK_ATTEMPTS = 3;
+constexpr uint32_t UNLOCK_LOCKOUT_MS = 60'000;
+
+enum Result : uint8_t {
+    RESULT_OK,
+    RESULT_UNKNOWN_COMMAND,
+    RESULT_BAD_ARGUMENT,
+    RESULT_LOCKED,
+};
+
+struct [[gnu::packed]] StatsReply
+{
+    uint32_t sensorBlocks;
+    uint32_t sensorOverruns;
+    uint32_t sensorErrors;
+    uint32_t controlLatencyMaxUs;
+    uint32_t controlProcessMaxUs;
+    uint32_t powerConversions;
+    uint32_t powerErrors;
+    uint32_t configFlushes;
+    uint32_t configFailures;
+    uint32_t telemetryFrames;
+    uint32_t telemetryDropped;
+    uint32_t remoteRequests;
+    uint32_t remoteErrors;
+};
+
+struct Stats
+{
+    uint32_t requests;
+    uint32_t errors;  // Broken or oversized frames, they get no response
+    uint32_t refused; // Write commands while locked and wrong PINs
+};
+
+/**
+ * @brief Start SD6 and the request handling thread
+ */
+void init();
+
+/**
+ * @brief Feed a byte received from the module, the request thread calls it.
+ * A complete request is executed and the response is written to SD6 right away.
+ */
+void Receive(uint8_t c);
+
+Stats GetStats();
+
+} // Remote
+
+#endif // REMOTE_H
@@ -21,26 +21,131 @@
  */
 
 #include "sensor_handler.h"
+#include "hal.h"
+#include "overheat.h"
+#include "sensor_processing.h"
+#include <algorithm>
 
 namespace Sensors {
 
-#include "hal.h"
+// Thermocouple amplifiers and dividers are high impedance sources, the longest sampling time is used
+constexpr auto SAMPLE_TIME = ADC_SAMPLE_480;
+// TIM4 CC4 is kept in phase with the heater PWM, see Drivers::Heater
+constexpr auto ADC_TRIGGER_TIM4_CC4 = 9;
+// The F401 has the temperature sensor on IN18 along with VBAT, which stays off
+constexpr auto ADC_CHANNEL_TEMP_SENSOR = ADC_CHANNEL_VBAT;
+
+// Factory calibration at VDDA = 3.3 V
+static const uint16_t& VREFINT_CAL = *reinterpret_cast<const uint16_t*>(0x1FFF7A2A);
+static const uint16_t& TS_CAL1 = *reinterpret_cast<const uint16_t*>(0x1FFF7A2C); // 30 C
+static const uint16_t& TS_CAL2 = *reinterpret_cast<const uint16_t*>(0x1FFF7A2E); // 110 C
+
+static adcsample_t samples[2 * BLOCK_SCANS * CHANNELS_NUM];
+static_assert(sizeof(samples) == 2 * sizeof(SampleBlock));
+
+static msg_t blocksQueue[2];
+static MAILBOX_DECL(blocks, blocksQueue, std::size(blocksQueue));
+
+static Stats stats;
+// Completion time of each half of the buffer
+static rtcnt_t blockStamps[2];
+
+static void adcCallback(ADCDriver* adcp)
+{
+    // The half just filled is processed while DMA writes the other one
+    auto* block = reinterpret_cast<const SampleBlock*>(adcIsBufferComplete(adcp) ? &samples[std::size(samples) / 2]
+                                                                                   : &samples[0]);
+    blockStamps[adcIsBufferComplete(adcp)] = chSysGetRealtimeCounterX();
+    chSysLockFromISR();
+    Overheat::WatchNextI();
+    if(chMBPostI(&blocks, (msg_t)block) != MSG_OK) {
+        ++stats.overruns;
+    }
+    chSysUnlockFromISR();
+}
+
+static void adcErrorCallback(ADCDriver*, adcerror_t)
+{
+    chSysLockFromISR();
+    ++stats.errors;
+    // Null block requests the conversion restart
+    chMBPostI(&blocks, (msg_t) nullptr);
+    chSysUnlockFromISR();
+}
+
+static const ADCConversionGroup adcgrpcfg = {
+  .circular = true,
+  .num_channels = CHANNELS_NUM,
+  .end_cb = adcCallback,
+  .error_cb = adcErrorCallback,
+  .cr1 = 0,
+  .cr2 = ADC_CR2_EXTEN_RISING | ADC_CR2_EXTSEL_SRC(ADC_TRIGGER_TIM4_CC4),
+  .smpr1 = ADC_SMPR1_SMP_VBAT(SAMPLE_TIME) | ADC_SMPR1_SMP_VREF(SAMPLE_TIME),
+  .smpr2 = ADC_SMPR2_SMP_AN0(SAMPLE_TIME) | ADC_SMPR2_SMP_AN1(SAMPLE_TIME) | ADC_SMPR2_SMP_AN2(SAMPLE_TIME) |
+           ADC_SMPR2_SMP_AN3(SAMPLE_TIME) | ADC_SMPR2_SMP_AN4(SAMPLE_TIME) | ADC_SMPR2_SMP_AN5(SAMPLE_TIME) |
+           ADC_SMPR2_SMP_AN6(SAMPLE_TIME) | ADC_SMPR2_SMP_AN7(SAMPLE_TIME) | ADC_SMPR2_SMP_AN8(SAMPLE_TIME),
+  .htr = 0,
+  .ltr = 0,
+  .sqr1 = ADC_SQR1_NUM_CH(CHANNELS_NUM),
+  .sqr2 = ADC_SQR2_SQ7_N(ADC_CHANNEL_IN0) |  /* LINE_HNDL_SEN1 */
+          ADC_SQR2_SQ8_N(ADC_CHANNEL_IN3) |  /* LINE_HNDL_SEN2 */
+          ADC_SQR2_SQ9_N(ADC_CHANNEL_IN6) |  /* LINE_HNDL_SEN3 */
+          ADC_SQR2_SQ10_N(ADC_CHANNEL_TEMP_SENSOR) |
+          ADC_SQR2_SQ11_N(ADC_CHANNEL_VREFINT),
+  .sqr3 = ADC_SQR3_SQ1_N(ADC_CHANNEL_IN1) |  /* LINE_TC1 */
+          ADC_SQR3_SQ2_N(ADC_CHANNEL_IN4) |  /* LINE_TC2 */
+          ADC_SQR3_SQ3_N(ADC_CHANNEL_IN7) |  /* LINE_TC3 */
+          ADC_SQR3_SQ4_N(ADC_CHANNEL_IN2) |  /* LINE_VIN1 */
+          ADC_SQR3_SQ5_N(ADC_CHANNEL_IN5) |  /* LINE_VIN2 */
+          ADC_SQR3_SQ6_N(ADC_CHANNEL_IN8),   /* LINE_VIN3 */
+};
+
+static void StartSampling()
+{
+    adcStartConversion(&ADCD1, &adcgrpcfg, samples, 2 * BLOCK_SCANS);
+}
 
 static THD_WORKING_AREA(HANDLER_WA_SIZE, 512);
 static THD_FUNCTION(sensorHandler, )
 {
+    StartSampling();
     while(true) {
-        //        palSetLine(LINE_LD2_LED);
-        chThdSleepMilliseconds(300);
-        //        palClearLine(LINE_LD2_LED);
-        chThdSleepMilliseconds(300);
+        msg_t msg;
+        chMBFetchTimeout(&blocks, &msg, TIME_INFINITE);
+        if(auto* block = reinterpret_cast<const SampleBlock*>(msg); block) {
+            auto stamp = blockStamps[block != reinterpret_cast<const SampleBlock*>(samples)];
+            auto start = chSysGetRealtimeCounterX();
+            ProcessBlock(*block);
+            auto end = chSysGetRealtimeCounterX();
+            uint32_t latencyUs = RTC2US(STM32_SYSCLK, start - stamp);
+            uint32_t processUs = RTC2US(STM32_SYSCLK, end - start);
+            chSysLock();
+            ++stats.blocks;
+            stats.latencyMaxUs = std::max(stats.latencyMaxUs, latencyUs);
+            stats.processMaxUs = std::max(stats.processMaxUs, processUs);
+            chSysUnlock();
+        }
+        else {
+            StartSampling();
+        }
     }
 }
 
 void init()
 {
-    auto* thd = chThdCreateStatic(HANDLER_WA_SIZE, sizeof(HANDLER_WA_SIZE), NORMALPRIO, sensorHandler, nullptr);
+    adcStart(&ADCD1, nullptr);
+    adcSTM32EnableTSVREFE();
+    SetCalibration({.vrefint = VREFINT_CAL, .ts30 = TS_CAL1, .ts110 = TS_CAL2});
+    auto* thd = chThdCreateStatic(HANDLER_WA_SIZE, sizeof(HANDLER_WA_SIZE), NORMALPRIO + 1, sensorHandler, nullptr);
     chRegSetThreadNameX(thd, "sensor_handler");
 }
 
+Stats GetStats()
+{
+    chSysLock();
+    auto result = stats;
+    chSysUnlock();
+    return result;
 }
+
+} // Sensors
@@ -23,10 +23,74 @@
 #ifndef SENSOR_H
 #define SENSOR_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 namespace Sensors {
 
+// ADC scan order, thermocouples go first to be converted as close to the scan start as possible
+enum Channel : uint8_t {
+    TC1,
+    TC2,
+    TC3,
+    VIN1,
+    VIN2,
+    VIN3,
+    HNDL_SEN1,
+    HNDL_SEN2,
+    HNDL_SEN3,
+    TEMP_SENSOR, // Internal ones, they go last as nothing waits for them
+    VREFINT,
+    CHANNELS_NUM
+};
+
+// One scan per heater period, in its heaters-off window
+constexpr size_t BLOCK_SCANS = 4;
+
+using sample_t = uint16_t;
+constexpr sample_t ADC_MAX = 0xFFF;
+using Scan = std::array<sample_t, CHANNELS_NUM>;
+// Half of the circular DMA buffer, handed to the processing thread in place
+using SampleBlock = std::array<Scan, BLOCK_SCANS>;
+
+/**
+ * @brief Slowly filtered from the internal channels, applied to every conversion by the control
+ */
+struct Reference
+{
+    float adcGain;          // Factory VREFINT reading over the present one, scales the counts to VDDA = 3.3 V
+    float boardTemperature; // Chip temperature, stands for the thermocouple cold junctions
+};
+
+struct Stats
+{
+    uint32_t blocks;
+    uint32_t overruns;     // Blocks dropped because the processing thread didn't keep up
+    uint32_t errors;       // ADC failures, the sampling is restarted after each one
+    uint32_t latencyMaxUs; // From the block completion interrupt to the processing start
+    uint32_t processMaxUs; // Block processing including the control step
+};
+
+/**
+ * @brief Longest run of each filter stage over the channels of a kind, CPU cycles
+ */
+struct FilterStats
+{
+    std::array<uint32_t, 2> tcCycles;  // Median, decimator
+    std::array<uint32_t, 3> vinCycles; // Median, decimator, IIR
+};
+
 void init();
 
-}
+/**
+ * @brief Per channel output of the filters for the last processed block, ADC counts
+ */
+sample_t GetAverage(Channel ch);
+Reference GetReference();
+FilterStats GetFilterStats();
+Stats GetStats();
+
+} // Sensors
 
 #endif // SENSOR_H
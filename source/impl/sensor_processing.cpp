@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sensor_processing.h"
+#include "ch.h"
+#include "filters.h"
+#include "simd.h"
+#include "telemetry.h"
+#include "temp_control.h"
+#include <algorithm>
+
+namespace Sensors {
+
+// Reference filter per block, about a second time constant at 50 blocks per second
+constexpr float REFERENCE_ALPHA = 1.0f / 64;
+
+struct RealtimeClock
+{
+    static uint32_t Now()
+    {
+        return chSysGetRealtimeCounterX();
+    }
+};
+
+// The median drops the heater switching spikes before the block average, the supply is smoothed further
+using TcFilter = Math::FilterChain<RealtimeClock, Math::RunningMedian<3>, Math::Decimator<BLOCK_SCANS>>;
+using VinFilter =
+  Math::FilterChain<RealtimeClock, Math::RunningMedian<3>, Math::Decimator<BLOCK_SCANS>, Math::SinglePoleIir<2>>;
+
+// The remaining channels are only averaged, two at a time through the packed sums
+constexpr size_t PLAIN_FIRST = HNDL_SEN1;
+constexpr size_t PLAIN_NUM = CHANNELS_NUM - HNDL_SEN1;
+static_assert(BLOCK_SCANS * ADC_MAX <= UINT16_MAX, "The packed sums are 16-bit");
+
+static_assert(std::tuple_size_v<decltype(FilterStats::tcCycles)> == TcFilter::STAGES);
+static_assert(std::tuple_size_v<decltype(FilterStats::vinCycles)> == VinFilter::STAGES);
+
+static TcFilter tcFilters[3];
+static VinFilter vinFilters[3];
+
+static std::array<sample_t, CHANNELS_NUM> averages;
+static Calibration calibration;
+static Reference reference;
+static bool referenceValid;
+
+void SetCalibration(const Calibration& factory)
+{
+    calibration = factory;
+}
+
+static void UpdateReference(sample_t tempSensor, sample_t vrefint)
+{
+    Reference sample;
+    sample.adcGain = float(calibration.vrefint) / float(std::max<sample_t>(vrefint, 1));
+    sample.boardTemperature = 30.0f + (tempSensor * sample.adcGain - calibration.ts30) * (110.0f - 30.0f) /
+                                       (calibration.ts110 - calibration.ts30);
+    Reference result = sample;
+    if(referenceValid) {
+        result.adcGain = reference.adcGain + (sample.adcGain - reference.adcGain) * REFERENCE_ALPHA;
+        result.boardTemperature =
+          reference.boardTemperature + (sample.boardTemperature - reference.boardTemperature) * REFERENCE_ALPHA;
+    }
+    chSysLock();
+    reference = result;
+    referenceValid = true;
+    chSysUnlock();
+}
+
+// The decimators give one output per block, the blocks always hold whole scans
+template<typename Filter>
+static void Feed(Filter& filter, const SampleBlock& block, size_t ch)
+{
+    int32_t out;
+    for(const auto& scan : block) {
+        if(filter.Process(scan[ch], out)) {
+            averages[ch] = sample_t(out);
+        }
+    }
+}
+
+void ProcessBlock(const SampleBlock& block)
+{
+    for(size_t i{}; i < std::size(tcFilters); ++i) {
+        Feed(tcFilters[i], block, TC1 + i);
+        Feed(vinFilters[i], block, VIN1 + i);
+    }
+    std::array<uint16_t, PLAIN_NUM> sums;
+    Simd::SumColumns<PLAIN_FIRST>(block, sums);
+    for(size_t i{}; i < PLAIN_NUM; ++i) {
+        averages[PLAIN_FIRST + i] = sample_t(sums[i] / BLOCK_SCANS);
+    }
+    UpdateReference(averages[TEMP_SENSOR], averages[VREFINT]);
+    Control::Update(averages, reference);
+    Telemetry::PublishScans(block, reference);
+}
+
+sample_t GetAverage(Channel ch)
+{
+    return averages[ch];
+}
+
+Reference GetReference()
+{
+    chSysLock();
+    auto result = reference;
+    chSysUnlock();
+    return result;
+}
+
+FilterStats GetFilterStats()
+{
+    FilterStats result{};
+    chSysLock();
+    for(size_t i{}; i < std::size(tcFilters); ++i) {
+        for(size_t stage{}; stage < TcFilter::STAGES; ++stage) {
+            result.tcCycles[stage] = std::max(result.tcCycles[stage], tcFilters[i].CyclesMax()[stage]);
+        }
+        for(size_t stage{}; stage < VinFilter::STAGES; ++stage) {
+            result.vinCycles[stage] = std::max(result.vinCycles[stage], vinFilters[i].CyclesMax()[stage]);
+        }
+    }
+    chSysUnlock();
+    return result;
+}
+
+} // Sensors
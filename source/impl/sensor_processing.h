@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SENSOR_PROCESSING_H
+#define SENSOR_PROCESSING_H
+
+#include "sensor_handler.h"
+
+namespace Sensors {
+
+/**
+ * @brief Factory calibration of the internal channels at VDDA = 3.3 V, read from the system memory on the target
+ */
+struct Calibration
+{
+    uint16_t vrefint;
+    uint16_t ts30;  // Temperature sensor at 30 C
+    uint16_t ts110; // Temperature sensor at 110 C
+};
+
+void SetCalibration(const Calibration& calibration);
+
+/**
+ * @brief Filter a block where the DMA left it, update the averages and the reference, then run the control step.
+ * It holds no ADC or DMA code, so the simulator builds it as it is.
+ */
+void ProcessBlock(const SampleBlock& block);
+
+} // Sensors
+
+#endif // SENSOR_PROCESSING_H
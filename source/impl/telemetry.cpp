@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "telemetry.h"
+#include "cppstreams.h"
+#include "frame.h"
+#include "power_monitor.h"
+#include "temp_control.h"
+
+namespace Telemetry {
+
+// The USART1 limit at 84 MHz APB2 with 16x oversampling
+constexpr uint32_t BAUDRATE = 5'250'000;
+// A buffer is filled while the other one is in flight
+constexpr size_t TX_BUFFER_SIZE = 512;
+constexpr size_t RX_QUEUE_SIZE = 16;
+constexpr size_t MAX_CONSOLES = 4;
+constexpr size_t LINE_SIZE = 128;
+
+static_assert(Utils::MaxFrameSize(sizeof(Sample)) <= TX_BUFFER_SIZE);
+
+struct TxBuffer
+{
+    uint8_t data[TX_BUFFER_SIZE];
+    size_t len;
+};
+
+static TxBuffer buffers[2];
+static size_t filling;
+// Set while a producer encodes into buffers[filling], the TX end handler leaves the buffer to it then
+static bool writing;
+static bool sending;
+static bool started;
+static uint8_t seq;
+static Stats stats;
+static MUTEX_DECL(txLock);
+
+static uint8_t rxBuffer[RX_QUEUE_SIZE];
+static INPUTQUEUE_DECL(rxQueue, rxBuffer, RX_QUEUE_SIZE, nullptr, nullptr);
+
+// I-class, starts the filled buffer if there is anything in it
+static void Kick()
+{
+    auto& buf = buffers[filling];
+    if(!buf.len) {
+        return;
+    }
+    filling ^= 1;
+    buffers[filling].len = 0;
+    sending = true;
+    uartStartSendI(&UARTD1, buf.len, buf.data);
+}
+
+static void TxEnd(UARTDriver*)
+{
+    chSysLockFromISR();
+    sending = false;
+    if(!writing) {
+        Kick();
+    }
+    chSysUnlockFromISR();
+}
+
+static void RxChar(UARTDriver*, uint16_t c)
+{
+    chSysLockFromISR();
+    iqPutI(&rxQueue, uint8_t(c));
+    chSysUnlockFromISR();
+}
+
+static const UARTConfig uartConfig{
+  .txend1_cb = TxEnd,
+  .rxchar_cb = RxChar,
+  .speed = BAUDRATE,
+  .cr1 = 0,
+  .cr2 = 0,
+  .cr3 = 0,
+};
+
+bool Send(FrameType type, const void* payload, size_t len)
+{
+    if(!started) {
+        return false;
+    }
+    chMtxLock(&txLock);
+    chSysLock();
+    writing = true;
+    auto& buf = buffers[filling];
+    chSysUnlock();
+    // The sequence number still advances for a dropped frame, so the host sees the gap
+    auto encoded = Utils::EncodeFrame(&buf.data[buf.len], TX_BUFFER_SIZE - buf.len, type, seq++, payload, len);
+    chSysLock();
+    buf.len += encoded;
+    writing = false;
+    if(encoded) {
+        ++stats.frames;
+    }
+    else {
+        ++stats.dropped;
+    }
+    if(!sending) {
+        Kick();
+    }
+    chSysUnlock();
+    chMtxUnlock(&txLock);
+    return encoded != 0;
+}
+
+Sample Collect()
+{
+    Sample sample;
+    sample.timeMs = uint32_t(TIME_I2MS(chVTGetSystemTimeX()));
+    sample.cutOff = Drivers::Heater::IsCutOff();
+    for(uint32_t ch{}; ch < Drivers::Heater::CHANNELS_NUM; ++ch) {
+        auto status = Control::GetStatus(Drivers::Heater::Channel(ch));
+        auto reading = PowerMonitor::GetReading(Drivers::Heater::Channel(ch));
+        sample.irons[ch] = {
+          .temperature = status.temperature,
+          .setpoint = status.setpoint,
+          .duty = status.duty,
+          .volts = reading ? reading->volts : 0.0f,
+          .amps = reading ? reading->amps : 0.0f,
+        };
+    }
+    return sample;
+}
+
+void PublishScans(const Sensors::SampleBlock& block, const Sensors::Reference& reference)
+{
+    constexpr uint32_t SCAN_PERIOD_MS = Drivers::Heater::PERIOD * 1000 / Drivers::Heater::TICK_FREQUENCY;
+    static_assert(SCAN_PERIOD_MS * Drivers::Heater::TICK_FREQUENCY == Drivers::Heater::PERIOD * 1000);
+    auto sample = Collect();
+    auto blockEndMs = sample.timeMs;
+    for(size_t scan{}; scan < block.size(); ++scan) {
+        // The block has just ended, the earlier scans are a heater period apart
+        sample.timeMs = blockEndMs - uint32_t(block.size() - 1 - scan) * SCAN_PERIOD_MS;
+        for(uint32_t ch{}; ch < Drivers::Heater::CHANNELS_NUM; ++ch) {
+            auto counts = block[scan][Sensors::TC1 + ch];
+            sample.irons[ch].temperature = Control::TipTemperature(Drivers::Heater::Channel(ch), counts, reference);
+        }
+        Publish(sample);
+    }
+}
+
+class Console : public streams::BaseSequentialStream
+{
+public:
+    size_t write(const uint8_t* bp, size_t n) override
+    {
+        for(size_t i{}; i < n; ++i) {
+            put(bp[i]);
+        }
+        return n;
+    }
+
+    size_t read(uint8_t* bp, size_t n) override
+    {
+        return iqReadTimeout(&rxQueue, bp, n, TIME_INFINITE);
+    }
+
+    msg_t put(uint8_t b) override
+    {
+        line_[len_++] = b;
+        if(b == '\n' || len_ == LINE_SIZE) {
+            Send(FRAME_TEXT, line_, len_);
+            len_ = 0;
+        }
+        return MSG_OK;
+    }
+
+    msg_t get() override
+    {
+        return iqGetTimeout(&rxQueue, TIME_INFINITE);
+    }
+
+private:
+    uint8_t line_[LINE_SIZE];
+    size_t len_{};
+};
+
+static Console consoles[MAX_CONSOLES];
+static size_t consolesUsed;
+
+void init()
+{
+    uartStart(&UARTD1, &uartConfig);
+    started = true;
+}
+
+BaseSequentialStream* OpenConsole()
+{
+    chSysLock();
+    auto* result = consolesUsed < MAX_CONSOLES ? consoles[consolesUsed++].getBase() : nullptr;
+    chSysUnlock();
+    return result;
+}
+
+Stats GetStats()
+{
+    chSysLock();
+    auto result = stats;
+    chSysUnlock();
+    return result;
+}
+
+} // Telemetry
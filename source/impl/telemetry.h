@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "hal.h"
+#include "heater.h"
+#include "sensor_handler.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * USART1 link, see Utils::EncodeFrame() for the framing
+ */
+namespace Telemetry {
+
+enum FrameType : uint8_t {
+    FRAME_SAMPLE = 1, // Sample, little-endian
+    FRAME_TEXT,       // A line of the debug console output
+    FRAME_LOG,        // DeferredLog record, little-endian words, tools/telemetry.py --elf formats it
+};
+
+struct IronSample
+{
+    float temperature;
+    float setpoint;
+    float duty;
+    float volts; // Zero while the power monitor has no reading
+    float amps;
+};
+
+struct Sample
+{
+    uint32_t timeMs; // Of the scan the temperatures come from
+    uint32_t cutOff; // Non-zero once the overheat watchdog has cut the heaters off
+    IronSample irons[Drivers::Heater::CHANNELS_NUM];
+};
+
+struct Stats
+{
+    uint32_t frames;
+    uint32_t dropped; // Both DMA buffers were busy
+};
+
+/**
+ * @brief Start USART1 with the DMA, the link carries the debug consoles as well.
+ * Not called with BARCODE_SCANNER, the frames are dropped then.
+ */
+void init();
+
+/**
+ * @brief Encode the frame right into the DMA buffer being filled, doesn't block on the transmission
+ * @return false if the frame was dropped
+ */
+bool Send(FrameType type, const void* payload, size_t len);
+
+/**
+ * @brief Snapshot of the control status and the power monitor readings
+ */
+Sample Collect();
+
+inline bool Publish(const Sample& sample)
+{
+    return Send(FRAME_SAMPLE, &sample, sizeof(sample));
+}
+
+/**
+ * @brief A sample per ADC scan of the block, 200 Hz, called by the sensor thread after the control step.
+ * The temperatures are converted from each scan as it is, unfiltered, the rest comes from Collect().
+ * That's the highest rate there is: the thermocouples are read once per heater period, in its off window.
+ */
+void PublishScans(const Sensors::SampleBlock& block, const Sensors::Reference& reference);
+
+/**
+ * @brief A text stream for a single thread, the output is buffered up to the line end and goes in a FRAME_TEXT.
+ * The input is the raw bytes received by the port, shared by all the consoles.
+ * @return nullptr when all the consoles are taken
+ */
+BaseSequentialStream* OpenConsole();
+
+Stats GetStats();
+
+} // Telemetry
+
+#endif // TELEMETRY_H
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "temp_control.h"
+#include "ch.h"
+#include "chlog.h"
+#include "config_store.h"
+#include "display_handler.h"
+#include "fixed_point.h"
+#include "hal.h"
+#include "overheat.h"
+#include "pid.h"
+#include "power_monitor.h"
+#include "power_scheduler.h"
+#include "thermocouple.h"
+#include <algorithm>
+#include <type_traits>
+
+namespace Control {
+
+using namespace Drivers;
+
+// Q16 trades the integral resolution for not touching the FPU in the sensor thread
+constexpr bool USE_FIXED_POINT = false;
+using real_t = std::conditional_t<USE_FIXED_POINT, Math::Q16, float>;
+using Pid = Math::Pid<real_t>;
+
+constexpr float DT = float(Heater::PERIOD * Sensors::BLOCK_SCANS) / Heater::TICK_FREQUENCY;
+
+constexpr float VIN_NOMINAL = 24.0f;
+constexpr float VIN_MIN = 12.0f;
+constexpr float VIN_VOLTS_PER_COUNT = 3.3f * 11 / 4096; // 1:11 divider
+// Rated cartridge power at VIN_NOMINAL
+constexpr float POWER_T245 = T245_DEFAULTS.maxPower;
+constexpr float POWER_C210 = C210_DEFAULTS.maxPower;
+// Below that the measured power is too coarse to derive the full power from
+constexpr float MIN_MEASURED_DUTY = 0.2f;
+
+constexpr Pid::Gains GAINS_T245{.kp = T245_DEFAULTS.kp, .ki = T245_DEFAULTS.ki, .kd = T245_DEFAULTS.kd};
+constexpr Pid::Gains GAINS_C210{.kp = C210_DEFAULTS.kp, .ki = C210_DEFAULTS.ki, .kd = C210_DEFAULTS.kd};
+
+struct ChannelControl
+{
+    Pid pid{GAINS_T245, DT};
+    float ratedPower{POWER_T245};
+    float maxPower{POWER_T245};
+    float tempOffset;
+    const Thermocouple::Table* tcTable{&Thermocouple::T245};
+    float setpoint;
+    Status status;
+};
+
+static ChannelControl channels[Heater::CHANNELS_NUM];
+// The stand contacts pull the lines low while the iron rests in it
+static constexpr ioline_t standLines[Heater::CHANNELS_NUM] = {LINE_SLEEP_SEN1, LINE_SLEEP_SEN2, LINE_SLEEP_SEN3};
+
+static void ApplyCartridgeI(Channel ch, Cartridge type)
+{
+    auto ratedPower = type == Cartridge::T245 ? POWER_T245 : POWER_C210;
+    channels[ch].pid.SetGains(type == Cartridge::T245 ? GAINS_T245 : GAINS_C210, DT);
+    channels[ch].ratedPower = ratedPower;
+    channels[ch].maxPower = ratedPower;
+    channels[ch].tempOffset = 0;
+    channels[ch].tcTable = type == Cartridge::T245 ? &Thermocouple::T245 : &Thermocouple::C210;
+}
+
+void init()
+{
+    for(uint32_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        channels[ch].setpoint = Config::Get(Config::Key(Config::SETPOINT_1 + ch), 0);
+        auto type = Cartridge(Config::Get(Config::Key(Config::CARTRIDGE_1 + ch), 0));
+        chSysLock();
+        ApplyCartridgeI(Channel(ch), type);
+        chSysUnlock();
+    }
+}
+
+void SetSetpoint(Channel ch, float celsius)
+{
+    channels[ch].setpoint = celsius;
+    Config::Set(Config::Key(Config::SETPOINT_1 + uint32_t(ch)), Config::value_t(celsius));
+}
+
+float GetSetpoint(Channel ch)
+{
+    return channels[ch].setpoint;
+}
+
+void SetCartridge(Channel ch, Cartridge type)
+{
+    chSysLock();
+    ApplyCartridgeI(ch, type);
+    Config::SetI(Config::Key(Config::CARTRIDGE_1 + uint32_t(ch)), Config::value_t(type));
+    // The stored tip belongs to the previous cartridge, it mustn't come back on the next start
+    Config::SetI(Config::Key(Config::TIP_1 + uint32_t(ch)), 0);
+    chSysUnlock();
+}
+
+void SetTip(Channel ch, const TipProfile& tip, uint32_t tipId)
+{
+    chSysLock();
+    channels[ch].pid.SetGains({.kp = tip.kp, .ki = tip.ki, .kd = tip.kd}, DT);
+    channels[ch].ratedPower = tip.cartridge == Cartridge::T245 ? POWER_T245 : POWER_C210;
+    channels[ch].maxPower = tip.maxPower;
+    channels[ch].tempOffset = tip.tempOffset;
+    channels[ch].tcTable = tip.cartridge == Cartridge::T245 ? &Thermocouple::T245 : &Thermocouple::C210;
+    Config::SetI(Config::Key(Config::CARTRIDGE_1 + uint32_t(ch)), Config::value_t(tip.cartridge));
+    Config::SetI(Config::Key(Config::TIP_1 + uint32_t(ch)), Config::value_t(tipId));
+    chSysUnlock();
+}
+
+Status GetStatus(Channel ch)
+{
+    chSysLock();
+    auto result = channels[ch].status;
+    chSysUnlock();
+    return result;
+}
+
+float TipTemperature(Channel ch, Sensors::sample_t tcCounts, const Sensors::Reference& reference)
+{
+    const auto& ctl = channels[ch];
+    // The EMF is close to linear around the room temperature, so the cold junction compensation is an offset
+    auto tcCelsius = float((*ctl.tcTable)(uint32_t(tcCounts * reference.adcGain)));
+    return reference.boardTemperature + tcCelsius + ctl.tempOffset;
+}
+
+static Power::Demand UpdateChannel(Channel ch,
+                                   Sensors::sample_t tcCounts,
+                                   Sensors::sample_t vinCounts,
+                                   const Sensors::Reference& reference,
+                                   bool& statusChanged)
+{
+    auto& ctl = channels[ch];
+    float temperature = TipTemperature(ch, tcCounts, reference);
+    // The watchdog compares the raw counts, the cutoff goes back through the same corrections
+    auto limit = Thermocouple::CountsFor(*ctl.tcTable,
+                                         Overheat::CUTOFF_CELSIUS - reference.boardTemperature - ctl.tempOffset);
+    Overheat::SetLimit(ch, Sensors::sample_t(std::min(float(limit) / reference.adcGain, float(Sensors::ADC_MAX))));
+    float vin = vinCounts * reference.adcGain * VIN_VOLTS_PER_COUNT;
+    float setpoint = ctl.setpoint;
+    float duty{};
+    // Nothing reaches the heaters after a cutoff, the integral mustn't wind up meanwhile
+    bool cutOff = Heater::IsCutOff();
+    if(setpoint > 0 && vin >= VIN_MIN && !cutOff) {
+        // Heater power goes with the square of the supply voltage
+        float ffGain = (VIN_NOMINAL * VIN_NOMINAL) / (vin * vin);
+        duty = float(ctl.pid.Update(real_t(setpoint), real_t(temperature), real_t(ffGain)));
+    }
+    else {
+        ctl.pid.Reset(real_t(temperature));
+    }
+    // Only this thread writes the status
+    if(cutOff && !ctl.status.cutOff) {
+        CHLOG("control: iron %u cut off at %d C", unsigned(ch) + 1, int(temperature));
+    }
+    statusChanged |= cutOff != ctl.status.cutOff || setpoint != ctl.status.setpoint;
+    chSysLock();
+    ctl.status.temperature = temperature;
+    ctl.status.setpoint = setpoint;
+    ctl.status.cutOff = cutOff;
+    chSysUnlock();
+    float fullPower = ctl.ratedPower * (vin * vin) / (VIN_NOMINAL * VIN_NOMINAL);
+    // The monitor averages over about 112 ms and reads low while the duty rises, so the measurement may only
+    // raise the rated figure. A low estimate would let the clamp and the budget grant more than the limits.
+    if(auto reading = PowerMonitor::GetReading(ch); reading && ctl.status.duty > MIN_MEASURED_DUTY) {
+        fullPower = std::max(fullPower, reading->watts / ctl.status.duty);
+    }
+    if(fullPower > 0) {
+        duty = std::min(duty, ctl.maxPower / fullPower);
+    }
+    return {.duty = duty, .fullPower = fullPower, .inUse = palReadLine(standLines[ch]) == PAL_HIGH};
+}
+
+void Update(const Sensors::Scan& averages, const Sensors::Reference& reference)
+{
+    bool statusChanged{};
+    Power::Demands demands{
+      UpdateChannel(Heater::IRON_1, averages[Sensors::TC1], averages[Sensors::VIN1], reference, statusChanged),
+      UpdateChannel(Heater::IRON_2, averages[Sensors::TC2], averages[Sensors::VIN2], reference, statusChanged),
+      UpdateChannel(Heater::IRON_3, averages[Sensors::TC3], averages[Sensors::VIN3], reference, statusChanged),
+    };
+    // A setpoint or the cutoff has reached the status, one wake-up covers all the channels
+    if(statusChanged) {
+        Ui::RequestRefresh();
+    }
+    auto maxTicks = Heater::GetMaxDuty();
+    auto slots = Power::Schedule(demands, maxTicks);
+    for(uint32_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        Heater::SetOnTime(Channel(ch), slots[ch].start, slots[ch].ticks);
+        chSysLock();
+        channels[ch].status.duty = float(slots[ch].ticks) / maxTicks;
+        chSysUnlock();
+    }
+}
+
+} // Control
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TEMP_CONTROL_H
+#define TEMP_CONTROL_H
+
+#include "heater.h"
+#include "sensor_handler.h"
+
+namespace Control {
+
+using Drivers::Heater::Channel;
+
+// Highest setpoint the user interfaces accept, Celsius
+constexpr float MAX_SETPOINT = 450.0f;
+
+enum class Cartridge : uint8_t {
+    T245,
+    C210,
+};
+
+/**
+ * @brief Tip specific parameters on top of the cartridge type
+ */
+struct TipProfile
+{
+    Cartridge cartridge;
+    float tempOffset; // Tip to sensor difference, added to the measured temperature
+    float kp;
+    float ki; // Per second
+    float kd; // Seconds
+    float maxPower; // Watts, the heater is never granted more
+};
+
+// The cartridge defaults at the rated power, the gains are tuned on the T245/C210 thermal mass difference
+constexpr TipProfile T245_DEFAULTS{
+  .cartridge = Cartridge::T245, .tempOffset = 0, .kp = 0.03f, .ki = 0.02f, .kd = 0.004f, .maxPower = 130.0f};
+constexpr TipProfile C210_DEFAULTS{
+  .cartridge = Cartridge::C210, .tempOffset = 0, .kp = 0.015f, .ki = 0.01f, .kd = 0.001f, .maxPower = 65.0f};
+
+struct Status
+{
+    float temperature;
+    float setpoint;
+    float duty;  // Granted fraction of the maximum heater on-time
+    bool cutOff; // The overheat watchdog has cut the heaters off, latched until reset
+};
+
+/**
+ * @brief Restore the stored setpoints and cartridge types, the config store must be loaded
+ */
+void init();
+
+/**
+ * @brief Target temperature, zero turns the channel off. Stored to the config.
+ */
+void SetSetpoint(Channel ch, float celsius);
+
+/**
+ * @brief The setpoint as last set, Status::setpoint follows it on the next control step
+ */
+float GetSetpoint(Channel ch);
+
+/**
+ * @brief The cartridge defaults, the tip profile is dropped. Stored to the config.
+ */
+void SetCartridge(Channel ch, Cartridge type);
+
+/**
+ * @brief Replace the cartridge defaults with the tip profile at once, the cartridge type included.
+ * Stored to the config together with the tip id, no control step sees a half applied change.
+ * @param tipId Tip table index + 1, zero for a profile which isn't in the table
+ */
+void SetTip(Channel ch, const TipProfile& tip, uint32_t tipId);
+Status GetStatus(Channel ch);
+
+/**
+ * @brief Run one control step for all the irons, called by the sensor thread for every sample block.
+ * The counts are corrected by the ADC gain, the board temperature is the cold junction one.
+ */
+void Update(const Sensors::Scan& averages, const Sensors::Reference& reference);
+
+/**
+ * @brief Tip temperature of a single thermocouple reading with the corrections of the control step,
+ * for the sensor thread
+ */
+float TipTemperature(Channel ch, Sensors::sample_t tcCounts, const Sensors::Reference& reference);
+
+} // Control
+
+#endif // TEMP_CONTROL_H
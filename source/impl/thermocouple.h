@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef THERMOCOUPLE_H
+#define THERMOCOUPLE_H
+
+#include "interpolation_table.h"
+
+namespace Thermocouple {
+
+// AD8221 with Rg = 180R in front of the 12 bit ADC
+constexpr double AMP_GAIN = 1 + 49.4e3 / 180;
+constexpr double MICROVOLTS_PER_COUNT = 3.3e6 / 4096 / AMP_GAIN;
+
+// Cartridge EMF in uV to degrees above the cold junction over 0..450 C
+constexpr Math::Polynomial<4> T245_EMF{{0.0, 4.27e-2, 1.2e-7, -4.0e-12}};
+constexpr Math::Polynomial<4> C210_EMF{{0.0, 4.5e-2, 1.0e-7, -3.0e-12}};
+
+// 64 segments of 64 counts, the interpolation error is far below a count
+using Table = Math::InterpolationTable<12, 6>;
+
+template<const auto& emf>
+consteval Table MakeTable()
+{
+    return Table{[](double counts) { return emf(counts * MICROVOLTS_PER_COUNT); }};
+}
+
+inline constexpr Table T245 = MakeTable<T245_EMF>();
+inline constexpr Table C210 = MakeTable<C210_EMF>();
+
+/**
+ * @brief The lowest count the table reads as celsius or more, MAX_INPUT when none does
+ */
+constexpr uint32_t CountsFor(const Table& table, float celsius)
+{
+    uint32_t low{}, high = Table::MAX_INPUT;
+    while(low < high) {
+        auto mid = (low + high) / 2;
+        if(float(table(mid)) >= celsius) {
+            high = mid;
+        }
+        else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+} // Thermocouple
+
+#endif // THERMOCOUPLE_H
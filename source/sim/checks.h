@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CHECKS_H
+#define CHECKS_H
+
+/**
+ * The jbc_sim modes kept out of sim_main.cpp, each one returns the process exit code
+ */
+
+// Bytes the display driver sends on the main screen updates, with and without the GRAM mirror
+int CheckDisplay();
+int CheckEeprom();
+// The INA3221 driver on the device model, its configuration, results and bus failures
+int CheckIna3221();
+// The key scanner on the given bounce trace or on a synthetic one, the events it makes and their latency
+int CheckKeys(const char* tracePath);
+// Writes the records of the order check as the telemetry frames to the capture if one is given
+int CheckLog(const char* capturePath);
+// The PID engine in float and Q16 on the cartridge models, its response limits and update time
+int CheckPid();
+// Supply current of the heaters with and without the power scheduler, its budget and layout on random demands
+int CheckPower();
+// The profiler report on the host registry, the thread loads, stacks and interrupt time
+int CheckProfiler();
+int CheckRemote();
+// Throughput of the sample block processing on a synthetic ADC source, and the averages it makes
+int CheckSampling();
+// The heaters against the thermocouple sampling window on the timer model
+int CheckTimeline();
+// Time of a main screen frame drawn in the page format against a set_px_cb call per pixel
+int CheckRender();
+
+#endif // CHECKS_H
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DISPLAY_BUS_H
+#define DISPLAY_BUS_H
+
+#include "s1d157xx.h"
+#include "s1d15710_model.h"
+#include <functional>
+
+namespace Sim {
+
+// Base address of the port the display is wired to, the specialization below stands for it
+constexpr uint32_t BUS_PORT_BASE = 0xFFFF'0000U;
+inline std::function<void(uint16_t previous, uint16_t odr)> busPortListener;
+
+} // Sim
+
+namespace Mcucpp::Gpio::Private {
+
+/**
+ * @brief Output register of the simulated port, every write goes to the listener with the levels before it
+ */
+template<uint32_t ID>
+class PortImplementation<Sim::BUS_PORT_BASE, ID>
+{
+public:
+    enum {
+        id = ID
+    };
+    static void Set(DataT value)
+    {
+        Update(odr_ | value);
+    }
+    static void Clear(DataT value)
+    {
+        Update(odr_ & ~value);
+    }
+    static void ClearAndSet(DataT clearMask, DataT value)
+    {
+        Update((odr_ & ~clearMask) | value);
+    }
+    static void Toggle(DataT value)
+    {
+        Update(odr_ ^ value);
+    }
+    static void Write(DataT value)
+    {
+        Update(value);
+    }
+    static DataT Read()
+    {
+        return odr_;
+    }
+    static DataT ReadODR()
+    {
+        return odr_;
+    }
+    template<DataT value>
+    static void Set()
+    {
+        Set(value);
+    }
+    template<DataT value>
+    static void Clear()
+    {
+        Clear(value);
+    }
+    template<DataT clearMask, DataT value>
+    static void ClearAndSet()
+    {
+        ClearAndSet(clearMask, value);
+    }
+    template<DataT mask, OutputConf, OutputMode>
+    static void SetConfig()
+    { }
+private:
+    static void Update(DataT odr)
+    {
+        auto previous = odr_;
+        odr_ = odr;
+        if(Sim::busPortListener) {
+            Sim::busPortListener(previous, odr);
+        }
+    }
+
+    static inline DataT odr_{};
+};
+
+} // Mcucpp::Gpio::Private
+
+namespace Sim {
+
+using BusPort = Mcucpp::Gpio::Private::PortImplementation<BUS_PORT_BASE, 0>;
+using DataPins = Mcucpp::Gpio::Pinlist<Mcucpp::Gpio::Private::TPin<BusPort, 0>, Mcucpp::Gpio::SequenceOf<8>>;
+using CsPin = Mcucpp::Gpio::Private::TPin<BusPort, 8>;
+using A0Pin = Mcucpp::Gpio::Private::TPin<BusPort, 9>;
+using ResPin = Mcucpp::Gpio::Private::TPin<BusPort, 10>;
+// The firmware driver on the simulated pins
+using Display = Drivers::S1d157xx<Drivers::S1D15710, DataPins, CsPin, A0Pin, ResPin>;
+
+/**
+ * @brief Decodes the pin levels the driver produces into the controller model: the byte on D0..D7
+ * is taken on the CS rising edge, A0 tells the display data from a command.
+ */
+class DisplayBus
+{
+public:
+    explicit DisplayBus(S1d15710Model& model)
+    {
+        busPortListener = [this, &model](uint16_t previous, uint16_t odr) {
+            if(!(previous & CsPin::mask) && (odr & CsPin::mask)) {
+                ++bytes_;
+                if(odr & A0Pin::mask) {
+                    model.Data(uint8_t(odr));
+                }
+                else {
+                    model.Command(uint8_t(odr));
+                }
+            }
+        };
+    }
+    ~DisplayBus()
+    {
+        busPortListener = nullptr;
+    }
+    DisplayBus(const DisplayBus&) = delete;
+    DisplayBus& operator=(const DisplayBus&) = delete;
+
+    /**
+     * @brief Bytes transferred since the start, commands included
+     */
+    size_t Bytes() const
+    {
+        return bytes_;
+    }
+private:
+    size_t bytes_{};
+};
+
+} // Sim
+
+#endif // DISPLAY_BUS_H
@@ -0,0 +1,601 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "display_bus.h"
+#include "mono_draw.h"
+#include "page_buffer.h"
+#include "s1d15710_model.h"
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * The GRAM mirror of the display driver on the typical main screen updates, the flushes go as flush_cb
+ * makes them. The bytes on the bus are compared with the whole flushed areas the driver used to send,
+ * the controller model GRAM is compared with the drawn frame after every flush.
+ * The render benchmark feeds the objects of ui_init() to the mono draw callbacks the way LVGL draws them,
+ * a page of rows per pass as the driver buffer holds, and to a call per pixel as the generic LVGL renderer
+ * did through set_px_cb. The frames must be bit exact and the passes must stay within their page.
+ */
+
+using Props = Sim::Display::Props;
+using MonoDraw::coord_t;
+using Frame = std::array<uint8_t, Props::X_DIM * Props::PAGES>;
+
+struct Area
+{
+    coord_t x1, y1, x2, y2;
+};
+
+// A column per iron: the temperature in seven segment digits and the power bar under it
+constexpr coord_t COLUMN_WIDTH = Props::X_DIM / 3;
+constexpr coord_t DIGITS = 3;
+constexpr coord_t DIGIT_WIDTH = 12;
+constexpr coord_t DIGIT_HEIGHT = 20;
+constexpr coord_t DIGIT_PITCH = DIGIT_WIDTH + 2;
+constexpr coord_t SEGMENT = 2;
+constexpr coord_t LABEL_LEFT = 8;
+constexpr coord_t LABEL_TOP = 4;
+constexpr coord_t SMALL_PITCH = 6;
+constexpr coord_t SETPOINT_TOP = 29;
+constexpr coord_t BAR_LEFT = 4;
+constexpr coord_t BAR_TOP = 44;
+constexpr coord_t BAR_HEIGHT = 8;
+constexpr coord_t BAR_WIDTH = COLUMN_WIDTH - 2 * BAR_LEFT;
+
+struct Screen
+{
+    std::array<int, 3> temperatures;
+    std::array<int, 3> setpoints;
+    std::array<int, 3> duties; // Percent
+};
+
+static Area LabelArea(size_t iron)
+{
+    auto x1 = coord_t(iron * COLUMN_WIDTH + LABEL_LEFT);
+    return {x1, LABEL_TOP, coord_t(x1 + DIGITS * DIGIT_PITCH - 3), coord_t(LABEL_TOP + DIGIT_HEIGHT - 1)};
+}
+
+static Area BarArea(size_t iron)
+{
+    auto x1 = coord_t(iron * COLUMN_WIDTH + BAR_LEFT);
+    return {x1, BAR_TOP, coord_t(x1 + BAR_WIDTH - 1), coord_t(BAR_TOP + BAR_HEIGHT - 1)};
+}
+
+// The page format primitives the LVGL draw context goes through, see mono_draw.cpp
+struct PagePainter
+{
+    MonoDraw::PageBuf pb;
+
+    void Fill(const Area& area, bool set) const
+    {
+        MonoDraw::fill(pb, area, set);
+    }
+    void Blit(const uint8_t* bitmap, const Area& area) const
+    {
+        MonoDraw::blit(pb, bitmap, area, area, true);
+    }
+};
+
+template<typename Painter>
+static void DrawDigit(const Painter& paint, coord_t x, coord_t y, int digit)
+{
+    // Segments a to g in the bit order
+    constexpr uint8_t SEGMENTS[10] = {0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F};
+    constexpr coord_t W = DIGIT_WIDTH - 1, H = DIGIT_HEIGHT - 1, M = DIGIT_HEIGHT / 2;
+    const Area segments[7] = {
+      {x, y, coord_t(x + W), coord_t(y + SEGMENT - 1)},
+      {coord_t(x + W - SEGMENT + 1), y, coord_t(x + W), coord_t(y + M)},
+      {coord_t(x + W - SEGMENT + 1), coord_t(y + M), coord_t(x + W), coord_t(y + H)},
+      {x, coord_t(y + H - SEGMENT + 1), coord_t(x + W), coord_t(y + H)},
+      {x, coord_t(y + M), coord_t(x + SEGMENT - 1), coord_t(y + H)},
+      {x, y, coord_t(x + SEGMENT - 1), coord_t(y + M)},
+      {x, coord_t(y + M - 1), coord_t(x + W), coord_t(y + M)},
+    };
+    for(size_t i{}; i < 7; ++i) {
+        if(SEGMENTS[digit] & (1U << i)) {
+            paint.Fill(segments[i], true);
+        }
+    }
+}
+
+// 5x7 A1 glyphs of the digits, the rows packed back to back MSB first as LVGL stores them
+static const std::array<std::array<uint8_t, 5>, 10> SMALL_DIGITS = [] {
+    constexpr uint8_t ROWS[10][7] = {
+      {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E},
+      {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E},
+      {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F},
+      {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E},
+      {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02},
+      {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E},
+      {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E},
+      {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},
+      {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E},
+      {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C},
+    };
+    std::array<std::array<uint8_t, 5>, 10> glyphs{};
+    for(size_t digit{}; digit < 10; ++digit) {
+        for(size_t bit{}; bit < 35; ++bit) {
+            if(ROWS[digit][bit / 5] & (0x10 >> (bit % 5))) {
+                glyphs[digit][bit >> 3] |= 0x80 >> (bit & 0x07);
+            }
+        }
+    }
+    return glyphs;
+}();
+
+template<typename Painter>
+static void DrawScreen(const Painter& paint, const Screen& screen)
+{
+    paint.Fill(Area{0, 0, Props::X_DIM - 1, Props::Y_DIM - 1}, false);
+    for(size_t iron{}; iron < 3; ++iron) {
+        auto label = LabelArea(iron);
+        auto value = screen.temperatures[iron];
+        for(auto i = DIGITS; i-- > 0; value /= 10) {
+            DrawDigit(paint, coord_t(label.x1 + i * DIGIT_PITCH), label.y1, value % 10);
+        }
+        // The setpoint in the small font, across a page boundary
+        value = screen.setpoints[iron];
+        for(auto i = DIGITS; i-- > 0; value /= 10) {
+            auto x = coord_t(label.x1 + i * SMALL_PITCH);
+            auto glyph = Area{x, SETPOINT_TOP, coord_t(x + 4), coord_t(SETPOINT_TOP + 6)};
+            paint.Blit(SMALL_DIGITS[value % 10].data(), glyph);
+        }
+        auto bar = BarArea(iron);
+        paint.Fill(Area{bar.x1, bar.y1, bar.x2, bar.y1}, true);
+        paint.Fill(Area{bar.x1, bar.y2, bar.x2, bar.y2}, true);
+        if(auto length = coord_t(screen.duties[iron] * BAR_WIDTH / 100)) {
+            paint.Fill(Area{bar.x1, bar.y1, coord_t(bar.x1 + length - 1), bar.y2}, true);
+        }
+    }
+}
+
+static void Draw(Frame& frame, const Screen& screen)
+{
+    DrawScreen(PagePainter{{frame.data(), 0, 0, Props::X_DIM}}, screen);
+}
+
+struct Traffic
+{
+    size_t bytes;
+    size_t unmirrored; // What the driver sent before the mirror: the page and column address and all the data
+};
+
+// The areas are rounded to the pages by rounder_cb, every page goes in one PutPage call
+static void Flush(const Sim::DisplayBus& bus, const Frame& frame, const Area& area, Traffic& traffic)
+{
+    auto before = bus.Bytes();
+    size_t width = area.x2 - area.x1 + 1;
+    for(size_t page = area.y1 >> 3; page <= size_t(area.y2 >> 3); ++page) {
+        Sim::Display::PutPage(area.x1, width, page, &frame[page * Props::X_DIM + area.x1]);
+        traffic.unmirrored += 3 + width;
+    }
+    traffic.bytes += bus.Bytes() - before;
+}
+
+static bool GramMatches(const Sim::S1d15710Model& model, const Frame& frame)
+{
+    for(size_t page{}; page < Props::PAGES; ++page) {
+        for(size_t x{}; x < Props::X_DIM; ++x) {
+            if(model.Gram(page, Props::X_OFFSET + x) != frame[page * Props::X_DIM + x]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int CheckDisplay()
+{
+    constexpr Area FULL{0, 0, Props::X_DIM - 1, Props::Y_DIM - 1};
+    Sim::S1d15710Model model;
+    Sim::DisplayBus bus{model};
+    Sim::Display::Init();
+    Frame frame{};
+    Screen screen{{25, 25, 25}, {350, 350, 320}, {0, 0, 0}};
+    Draw(frame, screen);
+    Traffic first{};
+    Flush(bus, frame, FULL, first);
+    bool gramOk = GramMatches(model, frame);
+
+    // The labels are set on every status update, mostly to the same text, and LVGL invalidates them anyway
+    Traffic steady{};
+    for(size_t update{}; update < 100; ++update) {
+        screen.temperatures[0] = 350 + int(update % 2);
+        Draw(frame, screen);
+        for(size_t iron{}; iron < 3; ++iron) {
+            Flush(bus, frame, LabelArea(iron), steady);
+        }
+        gramOk = gramOk && GramMatches(model, frame);
+    }
+    // All the irons heat up: every label and bar changes
+    Traffic heating{};
+    for(int update{}; update < 100; ++update) {
+        for(size_t iron{}; iron < 3; ++iron) {
+            screen.temperatures[iron] = 25 + update * 3 + int(iron);
+            screen.duties[iron] = 100 - update;
+        }
+        Draw(frame, screen);
+        for(size_t iron{}; iron < 3; ++iron) {
+            Flush(bus, frame, LabelArea(iron), heating);
+            Flush(bus, frame, BarArea(iron), heating);
+        }
+        gramOk = gramOk && GramMatches(model, frame);
+    }
+    Traffic redraw{};
+    Flush(bus, frame, FULL, redraw);
+
+    std::fprintf(stderr,
+                 "display: bytes sent of the flushed, first frame %zu/%zu, steady labels %zu/%zu, "
+                 "heating %zu/%zu, redraw %zu/%zu, gram %s\n",
+                 first.bytes,
+                 first.unmirrored,
+                 steady.bytes,
+                 steady.unmirrored,
+                 heating.bytes,
+                 heating.unmirrored,
+                 redraw.bytes,
+                 redraw.unmirrored,
+                 gramOk ? "matches" : "differs");
+    bool saved = first.bytes <= first.unmirrored && steady.bytes * 10 <= steady.unmirrored &&
+                 heating.bytes < heating.unmirrored && !redraw.bytes;
+    return gramOk && saved ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// The host time stamp counter stands in for DWT_CYCCNT
+static uint64_t Cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// A1 glyphs made up from the letter codes, the shapes don't matter to the draw path
+struct GlyphFont
+{
+    uint8_t width, height;
+    std::array<std::array<uint8_t, 64>, 128> bitmaps;
+};
+
+static GlyphFont MakeGlyphs(uint8_t width, uint8_t height)
+{
+    GlyphFont glyphs{width, height, {}};
+    for(uint32_t letter = '!'; letter < glyphs.bitmaps.size(); ++letter) {
+        for(uint32_t bit{}; bit < uint32_t(width * height); ++bit) {
+            if(((letter * 2654435761U) >> (bit % 23)) & 0x01) {
+                glyphs.bitmaps[letter][bit >> 3] |= 0x80 >> (bit & 0x07);
+            }
+        }
+    }
+    return glyphs;
+}
+
+static bool GetGlyph(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t)
+{
+    const auto& glyphs = *static_cast<const GlyphFont*>(font->dsc);
+    if(letter >= glyphs.bitmaps.size()) {
+        return false;
+    }
+    bool space = letter == ' ';
+    dsc->adv_w = glyphs.width + 1;
+    dsc->box_w = space ? 0 : glyphs.width;
+    dsc->box_h = space ? 0 : glyphs.height;
+    dsc->ofs_x = 0;
+    dsc->ofs_y = 0;
+    dsc->bpp = 1;
+    return true;
+}
+
+static const uint8_t* GetBitmap(const lv_font_t* font, uint32_t letter)
+{
+    return static_cast<const GlyphFont*>(font->dsc)->bitmaps[letter].data();
+}
+
+// The sizes of the ui_init() fonts: font5x7, unscii_8 and Hooge
+static const GlyphFont SMALL_GLYPHS = MakeGlyphs(5, 7), NORMAL_GLYPHS = MakeGlyphs(8, 8),
+                       BIG_GLYPHS = MakeGlyphs(16, 28);
+static const lv_font_t FONT_SMALL{GetGlyph, GetBitmap, 8, 1, &SMALL_GLYPHS};
+static const lv_font_t FONT_NORMAL{GetGlyph, GetBitmap, 8, 0, &NORMAL_GLYPHS};
+static const lv_font_t FONT_BIG{GetGlyph, GetBitmap, 30, 2, &BIG_GLYPHS};
+
+struct Box
+{
+    Area area;
+    coord_t radius;
+    coord_t border; // Zero for a filled box
+    bool set;
+};
+
+struct Text
+{
+    coord_t x, y;
+    const lv_font_t* font;
+    char text[8];
+};
+
+using MaskRow = std::array<lv_opa_t, Props::X_DIM>;
+
+struct MainScreen
+{
+    std::array<Box, 16> boxes;
+    size_t boxesNum;
+    std::array<Text, 16> texts;
+    size_t textsNum;
+    // The box masks LVGL makes while drawing, made up front to time the callbacks only
+    std::array<std::array<MaskRow, Props::Y_DIM>, 16> masks;
+    std::array<uint64_t, 16> coveredRows;
+};
+
+static bool InRoundedBox(const Area& area, coord_t radius, coord_t x, coord_t y)
+{
+    if(x < area.x1 || x > area.x2 || y < area.y1 || y > area.y2) {
+        return false;
+    }
+    int dx = x < area.x1 + radius ? area.x1 + radius - x : x > area.x2 - radius ? x - (area.x2 - radius) : 0;
+    int dy = y < area.y1 + radius ? area.y1 + radius - y : y > area.y2 - radius ? y - (area.y2 - radius) : 0;
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+// Opacity of a box pixel the way the LVGL masks cover it, nothing in between on a mono display
+static lv_opa_t Coverage(const Box& box, coord_t x, coord_t y)
+{
+    if(!InRoundedBox(box.area, box.radius, x, y)) {
+        return LV_OPA_TRANSP;
+    }
+    if(!box.border) {
+        return LV_OPA_COVER;
+    }
+    Area inner{coord_t(box.area.x1 + box.border),
+               coord_t(box.area.y1 + box.border),
+               coord_t(box.area.x2 - box.border),
+               coord_t(box.area.y2 - box.border)};
+    return InRoundedBox(inner, coord_t(std::max(box.radius - box.border, 0)), x, y) ? LV_OPA_TRANSP : LV_OPA_COVER;
+}
+
+static void MakeMasks(MainScreen& screen)
+{
+    for(size_t i{}; i < screen.boxesNum; ++i) {
+        const auto& box = screen.boxes[i];
+        screen.coveredRows[i] = 0;
+        for(auto y = box.area.y1; y <= box.area.y2; ++y) {
+            auto& row = screen.masks[i][y];
+            bool covered = true;
+            for(auto x = box.area.x1; x <= box.area.x2; ++x) {
+                row[x] = Coverage(box, x, y);
+                covered = covered && row[x] == LV_OPA_COVER;
+            }
+            screen.coveredRows[i] |= uint64_t(covered) << y;
+        }
+    }
+}
+
+// The objects of ui_init() at the places the layout puts them, bottom to top
+static void MakeMainScreen(MainScreen& screen, const std::array<int, 3>& temperatures, const std::array<int, 3>& bars,
+                           int big)
+{
+    screen.boxesNum = 0;
+    screen.textsNum = 0;
+    auto box = [&](const Box& b) { screen.boxes[screen.boxesNum++] = b; };
+    auto text = [&](coord_t x, coord_t y, const lv_font_t* font, int value) {
+        auto& t = screen.texts[screen.textsNum++];
+        t = {x, y, font, {}};
+        std::snprintf(t.text, sizeof(t.text), "%d", value);
+    };
+    auto label = [&](coord_t x, coord_t y, const lv_font_t* font, const char* value) {
+        auto& t = screen.texts[screen.textsNum++];
+        t = {x, y, font, {}};
+        std::snprintf(t.text, sizeof(t.text), "%s", value);
+    };
+    box({{0, 0, Props::X_DIM - 1, Props::Y_DIM - 1}, 0, 0, false});
+    constexpr coord_t IRON_TOPS[3] = {0, 19, 39}, PROFILE_TOPS[3] = {0, 21, 42};
+    for(size_t i{}; i < 3; ++i) {
+        auto y = IRON_TOPS[i];
+        box({{0, y, 84, coord_t(y + 20)}, 5, 1, true});
+        box({{54, coord_t(y + 13), 83, coord_t(y + 17)}, 0, 1, true});
+        if(auto length = coord_t(bars[i] * 30 / 100)) {
+            box({{54, coord_t(y + 13), coord_t(54 + length - 1), coord_t(y + 17)}, 0, 0, true});
+        }
+        text(58, coord_t(y + 2), &FONT_NORMAL, temperatures[i]);
+        label(31, coord_t(y + 7), &FONT_NORMAL, "BST");
+        label(2, coord_t(y + 2), &FONT_SMALL, "T245");
+        label(8, coord_t(y + 12), &FONT_SMALL, "BC3");
+    }
+    constexpr int PROFILES[3] = {310, 280, 150};
+    for(size_t i{}; i < 3; ++i) {
+        auto y = PROFILE_TOPS[i];
+        box({{190, y, 218, coord_t(y + 17)}, 5, 1, true});
+        text(i ? 196 : 193, coord_t(y + 5), i ? &FONT_SMALL : &FONT_NORMAL, PROFILES[i]);
+    }
+    text(127, 3, &FONT_BIG, big);
+    box({{177, 2, 184, 9}, 4, 3, true});
+    box({{188, 5, 189, 12}, 0, 0, true});
+    MakeMasks(screen);
+}
+
+// The rows of the pass, the fully covered ones in one blend, the rest a row at a time with its mask
+static void DrawBox(lv_draw_sw_ctx_t& ctx, const MainScreen& screen, size_t index)
+{
+    const auto& box = screen.boxes[index];
+    const auto* clip = ctx.base_draw.clip_area;
+    if(box.area.y2 < clip->y1 || box.area.y1 > clip->y2) {
+        return;
+    }
+    coord_t coveredFrom = -1;
+    auto blendCovered = [&](coord_t yEnd) {
+        if(coveredFrom >= 0) {
+            lv_area_t area{box.area.x1, coveredFrom, box.area.x2, yEnd};
+            lv_draw_sw_blend_dsc_t dsc{&area, nullptr, {box.set}, nullptr, LV_DRAW_MASK_RES_FULL_COVER, nullptr,
+                                       LV_OPA_COVER};
+            ctx.blend(&ctx.base_draw, &dsc);
+            coveredFrom = -1;
+        }
+    };
+    auto yEnd = std::min(box.area.y2, clip->y2);
+    for(auto y = std::max(box.area.y1, clip->y1); y <= yEnd; ++y) {
+        if(screen.coveredRows[index] & (uint64_t{1} << y)) {
+            coveredFrom = coveredFrom < 0 ? y : coveredFrom;
+            continue;
+        }
+        blendCovered(coord_t(y - 1));
+        lv_area_t area{box.area.x1, y, box.area.x2, y};
+        // LVGL hands the mask of the blend area only
+        auto* mask = const_cast<lv_opa_t*>(&screen.masks[index][y][box.area.x1]);
+        lv_draw_sw_blend_dsc_t dsc{&area, nullptr, {box.set}, mask, LV_DRAW_MASK_RES_CHANGED, &area, LV_OPA_COVER};
+        ctx.blend(&ctx.base_draw, &dsc);
+    }
+    blendCovered(yEnd);
+}
+
+static void DrawText(lv_draw_sw_ctx_t& ctx, const Text& text)
+{
+    lv_draw_label_dsc_t dsc{text.font, {1}, LV_OPA_COVER, LV_TEXT_DECOR_NONE};
+    lv_point_t pos{text.x, text.y};
+    for(const char* c = text.text; *c; ++c) {
+        ctx.base_draw.draw_letter(&ctx.base_draw, &dsc, &pos, uint8_t(*c));
+        lv_font_glyph_dsc_t g;
+        lv_font_get_glyph_dsc(text.font, &g, uint8_t(*c), 0);
+        pos.x = coord_t(pos.x + g.adv_w);
+    }
+}
+
+// What the generic LVGL renderer did before: the blends and the letter masks went through a set_px_cb call
+// per pixel, with the coordinates relative to the buffer area
+static void SetPx(lv_draw_ctx_t* ctx, coord_t x, coord_t y, bool set)
+{
+    auto bufWidth = lv_area_get_width(ctx->buf_area);
+    x = coord_t(x - ctx->buf_area->x1);
+    y = coord_t(y - ctx->buf_area->y1);
+    auto* col = (uint8_t*)ctx->buf + bufWidth * (y >> 3) + x;
+    if(set) {
+        (*col) |= (1 << (y % 8));
+    }
+    else {
+        (*col) &= ~(1 << (y % 8));
+    }
+}
+
+static void GenericBlend(lv_draw_ctx_t* ctx, const lv_draw_sw_blend_dsc_t* dsc)
+{
+    lv_area_t area;
+    if(!_lv_area_intersect(&area, dsc->blend_area, ctx->clip_area)) {
+        return;
+    }
+    auto maskStride = dsc->mask_buf ? lv_area_get_width(dsc->mask_area) : 0;
+    for(auto y = area.y1; y <= area.y2; ++y) {
+        for(auto x = area.x1; x <= area.x2; ++x) {
+            if(!dsc->mask_buf ||
+               dsc->mask_buf[(y - dsc->mask_area->y1) * maskStride + x - dsc->mask_area->x1] > LV_OPA_TRANSP) {
+                SetPx(ctx, x, y, dsc->color.full);
+            }
+        }
+    }
+}
+
+static void GenericLetter(lv_draw_ctx_t* ctx, const lv_draw_label_dsc_t* dsc, const lv_point_t* pos, uint32_t letter)
+{
+    lv_font_glyph_dsc_t g;
+    lv_font_get_glyph_dsc(dsc->font, &g, letter, 0);
+    auto* bitmap = lv_font_get_glyph_bitmap(dsc->font, letter);
+    coord_t left = coord_t(pos->x + g.ofs_x);
+    coord_t top = coord_t(pos->y + (dsc->font->line_height - dsc->font->base_line) - g.box_h - g.ofs_y);
+    for(uint32_t bit{}; bit < uint32_t(g.box_w * g.box_h); ++bit) {
+        coord_t x = coord_t(left + bit % g.box_w), y = coord_t(top + bit / g.box_w);
+        if(x >= ctx->clip_area->x1 && x <= ctx->clip_area->x2 && y >= ctx->clip_area->y1 &&
+           y <= ctx->clip_area->y2 && (bitmap[bit >> 3] & (0x80 >> (bit & 0x07)))) {
+            SetPx(ctx, x, y, dsc->color.full);
+        }
+    }
+}
+
+// The driver buffer, LVGL sees as many pixels as it has bytes, a page of rows per pass
+constexpr size_t RAW_BUF_SIZE = MonoDraw::BufferSize(Props::X_DIM, Props::Y_DIM);
+constexpr coord_t ROWS_PER_PASS = RAW_BUF_SIZE / Props::X_DIM / 8 * 8;
+constexpr uint8_t GUARD = 0xA5;
+
+// A frame the way lv_refr draws it: the passes in the buffer, every one put to the frame as flush_cb does
+static void RenderPasses(lv_draw_sw_ctx_t& ctx, const MainScreen& screen, Frame& frame, size_t& overruns)
+{
+    static std::array<uint8_t, RAW_BUF_SIZE> rawBuf;
+    for(coord_t y{}; y < Props::Y_DIM; y += ROWS_PER_PASS) {
+        lv_area_t bufArea{0, y, Props::X_DIM - 1, coord_t(y + ROWS_PER_PASS - 1)};
+        lv_area_t clip{0, y, Props::X_DIM - 1, std::min<coord_t>(bufArea.y2, Props::Y_DIM - 1)};
+        std::fill(rawBuf.begin() + Props::X_DIM, rawBuf.end(), GUARD);
+        ctx.base_draw.buf = rawBuf.data();
+        ctx.base_draw.buf_area = &bufArea;
+        ctx.base_draw.clip_area = &clip;
+        for(size_t i{}; i < screen.boxesNum; ++i) {
+            DrawBox(ctx, screen, i);
+        }
+        for(size_t i{}; i < screen.textsNum; ++i) {
+            DrawText(ctx, screen.texts[i]);
+        }
+        overruns += std::any_of(rawBuf.begin() + Props::X_DIM, rawBuf.end(), [](uint8_t b) { return b != GUARD; });
+        std::copy_n(rawBuf.begin(), Props::X_DIM, &frame[(y >> 3) * Props::X_DIM]);
+    }
+}
+
+int CheckRender()
+{
+    constexpr size_t FRAMES = 10'000;
+    static_assert(ROWS_PER_PASS == 8);
+    lv_disp_drv_t drv;
+    lv_draw_sw_ctx_t mono, generic{{nullptr, nullptr, nullptr, GenericLetter}, GenericBlend};
+    MonoDraw::draw_ctx_init_cb(&drv, &mono.base_draw);
+    static MainScreen screen;
+    Frame pages{}, pixels{};
+    size_t mismatches{}, overruns{};
+    uint64_t pagesCycles{}, pixelsCycles{};
+    for(size_t frame{}; frame < FRAMES; ++frame) {
+        std::array<int, 3> temperatures, bars;
+        for(size_t iron{}; iron < 3; ++iron) {
+            temperatures[iron] = int(25 + (frame * (iron + 1)) % 430);
+            bars[iron] = int((frame + iron * 30) % 101);
+        }
+        MakeMainScreen(screen, temperatures, bars, temperatures[frame % 3]);
+        auto start = Cycles();
+        RenderPasses(mono, screen, pages, overruns);
+        auto middle = Cycles();
+        RenderPasses(generic, screen, pixels, overruns);
+        auto end = Cycles();
+        pagesCycles += middle - start;
+        pixelsCycles += end - middle;
+        // The rows under the screen are left to whatever the previous pass drew
+        for(size_t i{}; i < pages.size(); ++i) {
+            uint8_t visible = i / Props::X_DIM == Props::PAGES - 1 ? 0xFF >> (Props::PAGES * 8 - Props::Y_DIM) : 0xFF;
+            mismatches += (pages[i] ^ pixels[i]) & visible ? 1 : 0;
+        }
+    }
+    std::fprintf(stderr,
+                 "render: %zu frames of the main screen, mono draw %llu, per pixel %llu host cycles a frame, "
+                 "%zu mismatches, %zu pass overruns, %u generic letters\n",
+                 FRAMES,
+                 (unsigned long long)(pagesCycles / FRAMES),
+                 (unsigned long long)(pixelsCycles / FRAMES),
+                 mismatches,
+                 overruns,
+                 unsigned(Sim::genericLetters));
+    return mismatches || overruns || Sim::genericLetters ? EXIT_FAILURE : EXIT_SUCCESS;
+}
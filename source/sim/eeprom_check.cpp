@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "config_log.h"
+#include "config_store.h"
+#include "i2c_fake.h"
+#include "m24c64.h"
+#include "m24c64_model.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+/**
+ * The config log of the firmware on the M24C64 driver against the EEPROM model: the values survive
+ * every reload, the wear spreads over the ring, a torn write loses its own batch only and a failed
+ * load doesn't let a store overwrite the live pages.
+ */
+
+constexpr size_t LOG_PAGES = 64;
+
+static Sim::M24c64Model eeprom;
+
+using Eeprom = Drivers::M24c64<Sim::I2cFake<eeprom>>;
+using ConfigLog = Config::Log<Eeprom, Config::KEYS_NUM, LOG_PAGES>;
+using Values = std::array<ConfigLog::value_t, Config::KEYS_NUM>;
+
+struct Snapshot
+{
+    Values values{};
+    uint64_t present{};
+
+    bool operator==(const Snapshot&) const = default;
+};
+
+static bool Reload(ConfigLog& log, Snapshot& snapshot)
+{
+    snapshot = {};
+    return log.Load([&snapshot](size_t key, ConfigLog::value_t value) {
+        snapshot.values[key] = value;
+        snapshot.present |= uint64_t{1} << key;
+    }) == Drivers::Status::Success;
+}
+
+// Random batches of one to three changes, the stored keys are reloaded by a fresh log every few hundred stores
+static bool CheckWear(Snapshot& expected, std::mt19937& rng)
+{
+    constexpr size_t STORES = 100'000;
+    constexpr size_t RELOAD_EVERY = 500;
+    constexpr uint64_t ALL = (uint64_t{1} << Config::KEYS_NUM) - 1;
+    constexpr uint32_t ENDURANCE = 1'000'000;
+    ConfigLog log;
+    Snapshot loaded;
+    if(!Reload(log, loaded) || loaded.present) {
+        std::fprintf(stderr, "eeprom: the blank log doesn't load empty\n");
+        return false;
+    }
+    size_t mismatches{};
+    for(size_t store{1}; store <= STORES; ++store) {
+        for(auto changes = rng() % 3 + 1; changes; --changes) {
+            auto key = rng() % Config::KEYS_NUM;
+            expected.values[key] = ConfigLog::value_t(rng());
+            expected.present |= uint64_t{1} << key;
+        }
+        if(log.Store(expected.values, ALL) != Drivers::Status::Success) {
+            std::fprintf(stderr, "eeprom: store %zu failed\n", store);
+            return false;
+        }
+        if(store % RELOAD_EVERY == 0) {
+            ConfigLog fresh;
+            mismatches += !Reload(fresh, loaded) || loaded != expected;
+        }
+    }
+    auto pagesWritten = log.GetStats().pagesWritten;
+    const auto& wear = eeprom.PageWrites();
+    auto [least, most] = std::minmax_element(wear.begin(), wear.begin() + LOG_PAGES);
+    std::fprintf(stderr,
+                 "eeprom: %zu stores, %.3f pages per store, page writes %u..%u, %.0f M stores to %u cycles, "
+                 "%zu reload mismatches\n",
+                 STORES,
+                 double(pagesWritten) / STORES,
+                 *least,
+                 *most,
+                 double(ENDURANCE) * LOG_PAGES / (double(pagesWritten) / STORES) / 1e6,
+                 ENDURANCE,
+                 mismatches);
+    return !mismatches && *most - *least <= 1;
+}
+
+// Power lost during a page write, the log is reloaded as it would be at the next boot
+static bool CheckTornWrite(Snapshot& expected, std::mt19937& rng)
+{
+    constexpr uint64_t ALL = (uint64_t{1} << Config::KEYS_NUM) - 1;
+    ConfigLog log;
+    Snapshot loaded;
+    size_t wrong{};
+    for(size_t tear{}; tear < Eeprom::PAGE_SIZE; ++tear) {
+        if(!Reload(log, loaded) || loaded != expected) {
+            ++wrong;
+            continue;
+        }
+        auto key = rng() % Config::KEYS_NUM;
+        auto previous = expected;
+        expected.values[key] = ConfigLog::value_t(expected.values[key] + 1);
+        eeprom.TearNextWrite(tear);
+        log.Store(expected.values, ALL);
+        ConfigLog rebooted;
+        // Only the key of the torn batch may go back to its previous value
+        if(!Reload(rebooted, loaded) || (loaded != expected && loaded != previous)) {
+            ++wrong;
+        }
+        expected = loaded;
+    }
+    std::fprintf(stderr, "eeprom: torn writes at every byte, %zu lost more than their batch\n", wrong);
+    return !wrong;
+}
+
+// A read failing part way through the load, then the bus recovers
+static bool CheckFailedLoad(Snapshot& expected)
+{
+    constexpr uint64_t ALL = (uint64_t{1} << Config::KEYS_NUM) - 1;
+    ConfigLog log;
+    Snapshot loaded;
+    eeprom.FailReads(1, 3);
+    auto writes = eeprom.PageWrites();
+    bool refused = !Reload(log, loaded) && log.Store(expected.values, ALL) != Drivers::Status::Success &&
+                   eeprom.PageWrites() == writes;
+    expected.values[0] = ConfigLog::value_t(expected.values[0] + 1);
+    bool recovered = Reload(log, loaded) && log.Store(expected.values, ALL) == Drivers::Status::Success;
+    ConfigLog rebooted;
+    bool kept = Reload(rebooted, loaded) && loaded == expected;
+    std::fprintf(stderr,
+                 "eeprom: failed load, store %s, after the retry %s\n",
+                 refused ? "refused" : "went through",
+                 recovered && kept ? "all the keys kept" : "keys lost");
+    return refused && recovered && kept;
+}
+
+int CheckEeprom()
+{
+    std::mt19937 rng{1};
+    Snapshot expected;
+    bool ok = CheckWear(expected, rng);
+    ok = CheckTornWrite(expected, rng) && ok;
+    ok = CheckFailedLoad(expected) && ok;
+    // The driver waits the write cycle out, the model refuses anything sent during one
+    std::fprintf(stderr, "eeprom: %u transfers during a write cycle\n", eeprom.BusyNacks());
+    return ok && !eeprom.BusyNacks() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef HEATER_TIMER_MODEL_H
+#define HEATER_TIMER_MODEL_H
+
+#include "hal.h"
+#include "heater.h"
+#include <array>
+#include <cstdint>
+
+namespace Sim {
+
+/**
+ * @brief TIM1 as the heater driver runs it, counted a tick at a time: the compare output modes of the channels
+ * 1 to 3, their interrupts and the update one, the main output enable, and TIM4 reset by the update with its
+ * CC4 match that triggers the scan. The interrupts run the given number of ticks after their event.
+ * The heater is on while its compare output is active, MOE is set and the driver enable line is high.
+ * The forced inactive mode is seen at the end of a tick, the driver never forces an output on the way to another mode
+ * while it is on.
+ */
+class HeaterTimerModel
+{
+public:
+    static constexpr uint32_t CHANNELS = Drivers::Heater::CHANNELS_NUM;
+    static constexpr uint32_t NO_TRIGGER = UINT32_MAX;
+
+    struct Period
+    {
+        std::array<uint32_t, CHANNELS> onTicks;
+        // Bit per channel for every tick of the period
+        std::array<uint8_t, Drivers::Heater::PERIOD> outputs;
+        uint32_t trigger; // Tick of the TIM4 CC4 match
+    };
+
+    explicit HeaterTimerModel(uint32_t latency = 0) : latency_{latency}
+    { }
+
+    void SetLatency(uint32_t ticks)
+    {
+        latency_ = ticks;
+    }
+
+    /**
+     * @brief Count a whole period from the update event, the hook is called at every tick before the timers,
+     * for the simulation to act in the middle of a period
+     */
+    template<typename Hook>
+    Period Run(Hook&& hook)
+    {
+        auto& tim = *PWMD1.tim;
+        Period period{};
+        period.trigger = NO_TRIGGER;
+        for(uint32_t cnt{}; cnt <= tim.ARR; ++cnt, ++now_) {
+            hook(cnt);
+            tim.CNT = cnt;
+            if(!cnt) {
+                Raise(UPDATE);
+            }
+            for(uint32_t ch{}; ch < CHANNELS; ++ch) {
+                if(tim.CCR[ch] == cnt) {
+                    Match(ch);
+                }
+            }
+            RunInterrupts();
+            if((STM32_TIM4->CR1 & TIM_CR1_CEN) && STM32_TIM4->CCR[3] == cnt) {
+                period.trigger = cnt;
+            }
+            for(uint32_t ch{}; ch < CHANNELS; ++ch) {
+                if(Mode(ch) == FORCED_INACTIVE) {
+                    ref_[ch] = false;
+                }
+                if(ref_[ch] && (tim.BDTR & TIM_BDTR_MOE) && palReadLine(LINE_PWM_EN) == PAL_HIGH) {
+                    ++period.onTicks[ch];
+                    period.outputs[cnt] |= 1U << ch;
+                }
+            }
+        }
+        return period;
+    }
+
+    Period Run()
+    {
+        return Run([](uint32_t) {});
+    }
+
+private:
+    // OCxM of the reference manual, the ones the driver uses
+    enum OutputMode : uint32_t {
+        ACTIVE_ON_MATCH = 0b001,
+        INACTIVE_ON_MATCH = 0b010,
+        FORCED_INACTIVE = 0b100,
+    };
+    static constexpr uint32_t UPDATE = CHANNELS;
+    static constexpr uint64_t IDLE = UINT64_MAX;
+
+    static OutputMode Mode(uint32_t ch)
+    {
+        auto ccmr = ch < 2 ? PWMD1.tim->CCMR1 : PWMD1.tim->CCMR2;
+        return OutputMode((ccmr >> ((ch & 1) ? 12 : 4)) & 0x07);
+    }
+
+    void Match(uint32_t ch)
+    {
+        if(Mode(ch) == ACTIVE_ON_MATCH) {
+            ref_[ch] = true;
+        }
+        else if(Mode(ch) == INACTIVE_ON_MATCH) {
+            ref_[ch] = false;
+        }
+        Raise(ch);
+    }
+
+    // A later event of the same source before the interrupt has run sets the same flag again
+    void Raise(uint32_t source)
+    {
+        auto enable = source == UPDATE ? TIM_DIER_UIE : 2U << source;
+        if((PWMD1.tim->DIER & enable) && pendingAt_[source] == IDLE) {
+            pendingAt_[source] = now_ + latency_;
+        }
+    }
+
+    // The update interrupt goes first, the channel ones in their order as the PWM driver serves them
+    void RunInterrupts()
+    {
+        const auto* config = PWMD1.config;
+        if(pendingAt_[UPDATE] <= now_) {
+            pendingAt_[UPDATE] = IDLE;
+            config->callback(&PWMD1);
+        }
+        for(uint32_t ch{}; ch < CHANNELS; ++ch) {
+            if(pendingAt_[ch] <= now_) {
+                pendingAt_[ch] = IDLE;
+                config->channels[ch].callback(&PWMD1);
+            }
+        }
+    }
+
+    uint32_t latency_;
+    uint64_t now_{};
+    std::array<uint64_t, CHANNELS + 1> pendingAt_{IDLE, IDLE, IDLE, IDLE};
+    std::array<bool, CHANNELS> ref_{};
+};
+
+} // Sim
+
+#endif // HEATER_TIMER_MODEL_H
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SIM_CH_H
+#define SIM_CH_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The part of the ChibiOS RT API the host built modules call. The host is single threaded: the locks are
+ * no-ops and the system time is a counter the simulation moves, sleeping just advances it.
+ */
+
+using systime_t = uint32_t;
+using sysinterval_t = uint32_t;
+using rtcnt_t = uint32_t;
+using rttime_t = uint64_t;
+using msg_t = int32_t;
+using eventflags_t = uint32_t;
+
+#define CH_CFG_ST_FREQUENCY 1000U
+#define TIME_MS2I(ms) (sysinterval_t((ms) * CH_CFG_ST_FREQUENCY / 1000U))
+#define TIME_I2MS(interval) (uint32_t((interval) * 1000U / CH_CFG_ST_FREQUENCY))
+
+#define MSG_OK msg_t(0)
+#define MSG_TIMEOUT msg_t(-1)
+#define MSG_RESET msg_t(-2)
+#define TIME_INFINITE sysinterval_t(-1)
+
+namespace Sim {
+inline systime_t systemTime;
+inline uint32_t realtimeCounter;
+} // Sim
+
+inline void chSysLock()
+{ }
+inline void chSysUnlock()
+{ }
+inline void chSysLockFromISR()
+{ }
+inline void chSysUnlockFromISR()
+{ }
+
+inline systime_t chVTGetSystemTimeX()
+{
+    return Sim::systemTime;
+}
+inline systime_t chVTGetSystemTime()
+{
+    return Sim::systemTime;
+}
+inline uint32_t chSysGetRealtimeCounterX()
+{
+    return Sim::realtimeCounter;
+}
+constexpr sysinterval_t chTimeDiffX(systime_t start, systime_t end)
+{
+    return sysinterval_t(end - start);
+}
+constexpr systime_t chTimeAddX(systime_t time, sysinterval_t interval)
+{
+    return systime_t(time + interval);
+}
+
+#define CH_DBG_STACK_FILL_VALUE 0x55
+
+// The firmware threads don't run on the host, the simulation switches the current one to act for them.
+// The registry holds the ones it declares, with their statistics and working areas as it sets them.
+struct thread_t
+{
+    void* log_writer;
+    struct
+    {
+        rttime_t cumulative;
+    } stats;
+    const char* name;
+    void* wabase;
+    thread_t* next;
+};
+
+using tprio_t = uint32_t;
+using tfunc_t = void (*)(void*);
+
+#define LOWPRIO tprio_t(1)
+#define NORMALPRIO tprio_t(128)
+#define THD_WORKING_AREA(name, size) uint8_t name[size]
+#define THD_FUNCTION(name, arg) void name(void* arg)
+
+namespace Sim {
+inline thread_t mainThread;
+inline thread_t* currentThread = &mainThread;
+inline thread_t* registry;
+
+// Appended to the registry, the thread structure is at the top of its working area as the kernel places it
+inline void Register(thread_t& thread, const char* name, void* wabase)
+{
+    thread.name = name;
+    thread.wabase = wabase;
+    thread.next = nullptr;
+    auto** last = &registry;
+    while(*last) {
+        last = &(*last)->next;
+    }
+    *last = &thread;
+}
+} // Sim
+
+inline thread_t* chThdGetSelfX()
+{
+    return Sim::currentThread;
+}
+inline bool port_is_isr_context()
+{
+    return false;
+}
+inline thread_t* chThdCreateStatic(void*, size_t, tprio_t, tfunc_t, void*)
+{
+    return nullptr;
+}
+inline void chRegSetThreadNameX(thread_t* tp, const char* name)
+{
+    if(tp) {
+        tp->name = name;
+    }
+}
+inline const char* chRegGetThreadNameX(thread_t* tp)
+{
+    return tp->name;
+}
+inline thread_t* chRegFirstThread()
+{
+    return Sim::registry;
+}
+inline thread_t* chRegNextThread(thread_t* tp)
+{
+    return tp->next;
+}
+inline void* chThdGetWorkingAreaX(thread_t* tp)
+{
+    return tp->wabase;
+}
+
+inline void chThdSleep(sysinterval_t interval)
+{
+    Sim::systemTime += interval;
+}
+inline void chThdSleepMilliseconds(uint32_t ms)
+{
+    chThdSleep(TIME_MS2I(ms));
+}
+
+struct event_source_t
+{
+    eventflags_t broadcast;
+};
+#define EVENTSOURCE_DECL(name) event_source_t name{}
+
+inline void chEvtBroadcastFlags(event_source_t* source, eventflags_t flags)
+{
+    source->broadcast |= flags;
+}
+inline void chEvtBroadcastFlagsI(event_source_t* source, eventflags_t flags)
+{
+    source->broadcast |= flags;
+}
+
+#endif // SIM_CH_H
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SIM_CH_HPP
+#define SIM_CH_HPP
+
+#include "ch.h"
+
+/**
+ * The chibios_rt names ch_extended.h brings in. Declarations only: the host built code must not
+ * create threads or block, the single threaded simulation has nobody to wake it up.
+ */
+
+using thread_reference_t = thread_t*;
+
+msg_t chThdSuspendS(thread_reference_t* trp);
+msg_t chThdSuspendTimeoutS(thread_reference_t* trp, sysinterval_t timeout);
+void chThdResumeS(thread_reference_t* trp, msg_t msg);
+void chThdResumeI(thread_reference_t* trp, msg_t msg);
+
+namespace chibios_rt {
+
+class BaseThread;
+template<int N>
+class BaseStaticThread;
+template<typename T, int N>
+class Mailbox;
+class ThreadReference;
+
+struct System
+{
+    static void lock()
+    {
+        chSysLock();
+    }
+    static void unlock()
+    {
+        chSysUnlock();
+    }
+    static void lockFromIsr()
+    {
+        chSysLockFromISR();
+    }
+    static void unlockFromIsr()
+    {
+        chSysUnlockFromISR();
+    }
+};
+
+// Nothing else runs, so the semaphore is always free when it's waited for
+class BinarySemaphore
+{
+public:
+    explicit BinarySemaphore(bool taken) : taken_{taken}
+    { }
+    msg_t wait()
+    {
+        taken_ = true;
+        return MSG_OK;
+    }
+    void signal()
+    {
+        taken_ = false;
+    }
+private:
+    bool taken_;
+};
+
+} // chibios_rt
+
+#endif // SIM_CH_HPP
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include "ch.h"
+#include <bitset>
+#include <cstddef>
+#include <vector>
+
+/**
+ * PAL lines, the PWM and the stream interface of the ChibiOS HAL for the host, the line levels are set
+ * by the simulation
+ */
+
+using ioline_t = uint32_t;
+using iopadid_t = uint32_t;
+
+#define PAL_LOW 0U
+#define PAL_HIGH 1U
+#define PAL_LINE(port, pad) (ioline_t((port) * 16U + (pad)))
+
+#define GPIOA 0U
+#define GPIOB 1U
+#define GPIOC 2U
+
+// The lines the host built modules refer to, as the board defines them
+#define LINE_SLEEP_SEN1 PAL_LINE(GPIOB, 13U)
+#define LINE_SLEEP_SEN2 PAL_LINE(GPIOB, 14U)
+#define LINE_SLEEP_SEN3 PAL_LINE(GPIOB, 15U)
+#define LINE_PWM_EN PAL_LINE(GPIOB, 1U)
+
+namespace Sim {
+inline std::bitset<8 * 16> lineLevels;
+} // Sim
+
+inline uint32_t palReadLine(ioline_t line)
+{
+    return Sim::lineLevels[line] ? PAL_HIGH : PAL_LOW;
+}
+inline void palSetLine(ioline_t line)
+{
+    Sim::lineLevels[line] = true;
+}
+inline void palClearLine(ioline_t line)
+{
+    Sim::lineLevels[line] = false;
+}
+
+struct BaseSequentialStream;
+
+// The timer registers the heater driver writes, the heater timer model counts and matches on them
+struct stm32_tim_t
+{
+    volatile uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR, CCR[4], BDTR;
+};
+
+#define TIM_CR1_CEN 0x0001U
+#define TIM_CR2_MMS_1 0x0020U
+#define TIM_SMCR_SMS_2 0x0004U
+#define TIM_DIER_UIE 0x0001U
+#define TIM_EGR_UG 0x0001U
+#define TIM_CCMR2_OC4M_0 0x1000U
+#define TIM_CCMR2_OC4M_1 0x2000U
+#define TIM_CCMR2_OC4M_2 0x4000U
+#define TIM_BDTR_MOE 0x8000U
+
+// TIM1 on APB2 and TIM4 on APB1 both count at 84 MHz
+#define STM32_TIMCLK1 84'000'000U
+#define STM32_TIMCLK2 84'000'000U
+
+struct PWMDriver;
+using pwmcallback_t = void (*)(PWMDriver* pwmp);
+using pwmchannel_t = uint8_t;
+using pwmcnt_t = uint32_t;
+
+#define PWM_CHANNELS 4U
+#define PWM_OUTPUT_DISABLED 0x00U
+#define PWM_OUTPUT_ACTIVE_HIGH 0x01U
+
+struct PWMChannelConfig
+{
+    uint32_t mode;
+    pwmcallback_t callback;
+};
+
+struct PWMConfig
+{
+    uint32_t frequency;
+    pwmcnt_t period;
+    pwmcallback_t callback;
+    PWMChannelConfig channels[PWM_CHANNELS];
+    uint32_t cr2;
+    uint32_t bdtr;
+    uint32_t dier;
+};
+
+struct PWMDriver
+{
+    const PWMConfig* config;
+    stm32_tim_t* tim;
+};
+
+namespace Sim {
+inline stm32_tim_t tim1;
+inline stm32_tim_t tim4;
+} // Sim
+
+inline PWMDriver PWMD1{nullptr, &Sim::tim1};
+#define STM32_TIM4 (&Sim::tim4)
+
+inline void pwmStart(PWMDriver* pwmp, const PWMConfig* config)
+{
+    pwmp->config = config;
+    pwmp->tim->ARR = config->period - 1;
+    pwmp->tim->CR2 = config->cr2;
+    pwmp->tim->DIER = config->dier;
+    pwmp->tim->BDTR = config->bdtr | TIM_BDTR_MOE;
+    pwmp->tim->CR1 = TIM_CR1_CEN;
+}
+inline void pwmEnableChannel(PWMDriver* pwmp, pwmchannel_t channel, pwmcnt_t width)
+{
+    pwmp->tim->CCR[channel] = width;
+}
+inline void pwmEnableChannelNotification(PWMDriver* pwmp, pwmchannel_t channel)
+{
+    pwmp->tim->DIER = pwmp->tim->DIER | (2U << channel);
+}
+inline void pwmEnablePeriodicNotification(PWMDriver* pwmp)
+{
+    pwmp->tim->DIER = pwmp->tim->DIER | TIM_DIER_UIE;
+}
+inline void rccEnableTIM4(bool)
+{ }
+inline void rccResetTIM4()
+{
+    Sim::tim4 = {};
+}
+
+// The I2C driver type the firmware bus is templated on, the devices run on the fake buses of the simulation
+enum i2copmode_t { OPMODE_I2C = 1 };
+enum i2cdutycycle_t { STD_DUTY_CYCLE = 1, FAST_DUTY_CYCLE_2 = 2 };
+enum i2cstate_t { I2C_UNINIT, I2C_STOP, I2C_READY };
+
+struct I2CConfig
+{
+    i2copmode_t op_mode;
+    uint32_t clock_speed;
+    i2cdutycycle_t duty_cycle;
+};
+
+struct I2CDriver
+{
+    i2cstate_t state;
+    const I2CConfig* config;
+};
+
+extern I2CDriver I2CD1;
+
+void i2cStart(I2CDriver* i2cp, const I2CConfig* config);
+void i2cStop(I2CDriver* i2cp);
+void i2cAcquireBus(I2CDriver* i2cp);
+void i2cReleaseBus(I2CDriver* i2cp);
+msg_t i2cMasterTransmitTimeout(I2CDriver* i2cp,
+                               uint8_t addr,
+                               const uint8_t* txbuf,
+                               size_t txbytes,
+                               uint8_t* rxbuf,
+                               size_t rxbytes,
+                               sysinterval_t timeout);
+msg_t i2cMasterReceiveTimeout(I2CDriver* i2cp, uint8_t addr, uint8_t* rxbuf, size_t rxbytes, sysinterval_t timeout);
+
+// The serial port the remote answers on, the simulation reads what was written and feeds the received bytes itself
+struct SerialConfig
+{
+    uint32_t speed;
+    uint16_t cr1;
+    uint16_t cr2;
+    uint16_t cr3;
+};
+
+struct SerialDriver
+{
+    const SerialConfig* config;
+};
+
+inline SerialDriver SD6;
+
+namespace Sim {
+inline std::vector<uint8_t> serialOut;
+} // Sim
+
+inline void sdStart(SerialDriver* sdp, const SerialConfig* config)
+{
+    sdp->config = config;
+}
+inline size_t sdWrite(SerialDriver*, const uint8_t* bp, size_t n)
+{
+    Sim::serialOut.insert(Sim::serialOut.end(), bp, bp + n);
+    return n;
+}
+inline msg_t sdGetTimeout(SerialDriver*, sysinterval_t)
+{
+    return MSG_TIMEOUT;
+}
+
+#endif // SIM_HAL_H
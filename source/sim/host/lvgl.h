@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SIM_LVGL_H
+#define SIM_LVGL_H
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * The part of the LVGL 8.3 draw context API the mono draw callbacks use, LV_COLOR_DEPTH 1. The field names
+ * are LVGL's, the layouts are not. The generic renderers don't exist on the host: the letters the callbacks
+ * leave to lv_draw_sw_letter() are counted only.
+ */
+
+using lv_coord_t = int16_t;
+using lv_opa_t = uint8_t;
+
+enum : lv_opa_t {
+    LV_OPA_TRANSP = 0,
+    LV_OPA_MIN = 2,
+    LV_OPA_COVER = 255,
+};
+
+enum lv_draw_mask_res_t : uint8_t {
+    LV_DRAW_MASK_RES_TRANSP,
+    LV_DRAW_MASK_RES_FULL_COVER,
+    LV_DRAW_MASK_RES_CHANGED,
+    LV_DRAW_MASK_RES_UNKNOWN,
+};
+
+enum lv_text_decor_t : uint8_t {
+    LV_TEXT_DECOR_NONE = 0x00,
+    LV_TEXT_DECOR_UNDERLINE = 0x01,
+};
+
+struct lv_color_t
+{
+    uint8_t full;
+};
+
+struct lv_point_t
+{
+    lv_coord_t x, y;
+};
+
+struct lv_area_t
+{
+    lv_coord_t x1, y1, x2, y2;
+};
+
+struct lv_font_t;
+
+struct lv_font_glyph_dsc_t
+{
+    const lv_font_t* resolved_font;
+    uint16_t adv_w;
+    uint16_t box_w;
+    uint16_t box_h;
+    int16_t ofs_x;
+    int16_t ofs_y;
+    uint8_t bpp;
+};
+
+struct lv_font_t
+{
+    bool (*get_glyph_dsc)(const lv_font_t*, lv_font_glyph_dsc_t*, uint32_t letter, uint32_t letter_next);
+    const uint8_t* (*get_glyph_bitmap)(const lv_font_t*, uint32_t letter);
+    lv_coord_t line_height;
+    lv_coord_t base_line;
+    const void* dsc;
+};
+
+struct lv_draw_label_dsc_t
+{
+    const lv_font_t* font;
+    lv_color_t color;
+    lv_opa_t opa;
+    lv_text_decor_t decor;
+};
+
+struct lv_disp_drv_t
+{ };
+
+struct lv_draw_ctx_t
+{
+    void* buf;
+    lv_area_t* buf_area;
+    const lv_area_t* clip_area;
+    void (*draw_letter)(lv_draw_ctx_t*, const lv_draw_label_dsc_t*, const lv_point_t*, uint32_t letter);
+};
+
+struct lv_draw_sw_blend_dsc_t
+{
+    const lv_area_t* blend_area;
+    const lv_color_t* src_buf;
+    lv_color_t color;
+    lv_opa_t* mask_buf;
+    lv_draw_mask_res_t mask_res;
+    const lv_area_t* mask_area;
+    lv_opa_t opa;
+};
+
+struct lv_draw_sw_ctx_t
+{
+    lv_draw_ctx_t base_draw;
+    void (*blend)(lv_draw_ctx_t*, const lv_draw_sw_blend_dsc_t*);
+};
+
+namespace Sim {
+inline uint32_t genericLetters;
+} // Sim
+
+inline lv_coord_t lv_area_get_width(const lv_area_t* area)
+{
+    return lv_coord_t(area->x2 - area->x1 + 1);
+}
+
+inline bool _lv_area_intersect(lv_area_t* res, const lv_area_t* a, const lv_area_t* b)
+{
+    *res = {std::max(a->x1, b->x1), std::max(a->y1, b->y1), std::min(a->x2, b->x2), std::min(a->y2, b->y2)};
+    return res->x1 <= res->x2 && res->y1 <= res->y2;
+}
+
+inline bool lv_font_get_glyph_dsc(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t next)
+{
+    dsc->resolved_font = font;
+    return font->get_glyph_dsc(font, dsc, letter, next);
+}
+
+inline const uint8_t* lv_font_get_glyph_bitmap(const lv_font_t* font, uint32_t letter)
+{
+    return font->get_glyph_bitmap(font, letter);
+}
+
+inline void lv_draw_sw_letter(lv_draw_ctx_t*, const lv_draw_label_dsc_t*, const lv_point_t*, uint32_t)
+{
+    ++Sim::genericLetters;
+}
+
+inline void lv_draw_sw_init_ctx(lv_disp_drv_t*, lv_draw_ctx_t* draw_ctx)
+{
+    *(lv_draw_sw_ctx_t*)draw_ctx = {};
+}
+
+#endif // SIM_LVGL_H
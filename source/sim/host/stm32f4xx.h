@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SIM_STM32F4XX_H
+#define SIM_STM32F4XX_H
+
+#include <cstdint>
+
+/**
+ * The CMSIS names gpio.h refers to. The ports never reach these registers on the host,
+ * the simulation specializes the port template for its own base address instead.
+ */
+
+struct GPIO_TypeDef
+{
+    uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2];
+};
+
+struct EXTI_TypeDef
+{
+    uint32_t IMR, EMR, RTSR, FTSR, SWIER, PR;
+};
+
+struct SYSCFG_TypeDef
+{
+    uint32_t MEMRMP, PMC, EXTICR[4];
+};
+
+struct RCC_TypeDef
+{
+    uint32_t AHB1ENR;
+};
+
+enum IRQn_Type {
+    EXTI1_IRQn = 7,
+    EXTI2_IRQn = 8,
+    EXTI3_IRQn = 9,
+};
+
+#define GPIOA_BASE 0x40020000U
+#define GPIOB_BASE 0x40020400U
+#define GPIOC_BASE 0x40020800U
+#define GPIOD_BASE 0x40020C00U
+#define GPIOE_BASE 0x40021000U
+#define GPIOH_BASE 0x40021C00U
+#define RCC_AHB1ENR_GPIOAEN 0x00000001U
+
+namespace Sim {
+inline EXTI_TypeDef exti;
+inline SYSCFG_TypeDef syscfg;
+inline RCC_TypeDef rcc;
+} // Sim
+
+#define EXTI (&Sim::exti)
+#define SYSCFG (&Sim::syscfg)
+#define RCC (&Sim::rcc)
+
+inline void NVIC_EnableIRQ(IRQn_Type)
+{ }
+inline void NVIC_DisableIRQ(IRQn_Type)
+{ }
+inline void NVIC_SetPriority(IRQn_Type, uint32_t)
+{ }
+
+#endif // SIM_STM32F4XX_H
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef I2C_FAKE_H
+#define I2C_FAKE_H
+
+#include "i2c_bus.h"
+
+namespace Sim {
+
+/**
+ * @brief Bus policy for the firmware I2C device drivers that hands the transfers to a device model.
+ * The model takes the same arguments and tells whether the device acknowledged.
+ */
+template<auto& device>
+struct I2cFake
+{
+    static Drivers::Status Transfer(uint8_t address, const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen)
+    {
+        return device.Transfer(address, tx, txLen, rx, rxLen) ? Drivers::Status::Success : Drivers::Status::Failure;
+    }
+};
+
+} // Sim
+
+#endif // I2C_FAKE_H
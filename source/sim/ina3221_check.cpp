@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "i2c_fake.h"
+#include "ina3221.h"
+#include "ina3221_model.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+/**
+ * The INA3221 driver on the device model: a device with a foreign id is refused, the configuration reaches it,
+ * the conversion ready flag is seen once per conversion and the results of random inputs come back in range and
+ * sign. Bus failures at any transfer of a read are reported, and the next read goes through.
+ */
+
+static Sim::Ina3221Model monitor;
+static Sim::Ina3221Model foreign{0x3221};
+
+using Monitor = Drivers::Ina3221<Sim::I2cFake<monitor>>;
+using Foreign = Drivers::Ina3221<Sim::I2cFake<foreign>>;
+
+constexpr auto AVERAGING = Monitor::AVG_4;
+constexpr auto BUS_CT = Monitor::CT_1100US;
+constexpr auto SHUNT_CT = Monitor::CT_8244US;
+
+static bool Ready()
+{
+    bool ready{};
+    return Monitor::PollConversionReady(ready) == Drivers::Status::Success && ready;
+}
+
+int CheckIna3221()
+{
+    constexpr size_t CONVERSIONS = 10'000;
+    constexpr int32_t SHUNT_FULL_SCALE_UV = 163'800;
+    constexpr int32_t BUS_FULL_SCALE_MV = 26'000;
+    bool refused = Foreign::Init(Foreign::AVG_4, Foreign::CT_1100US, Foreign::CT_8244US) != Drivers::Status::Success &&
+                   foreign.Config() == Sim::Ina3221Model::RESET_CONFIG;
+    bool configured = Monitor::Init(AVERAGING, BUS_CT, SHUNT_CT) == Drivers::Status::Success &&
+                      monitor.Config() == (0x7000 | AVERAGING << 9 | BUS_CT << 6 | SHUNT_CT << 3 | 0b111);
+    // Nothing converted yet, then a single ready per conversion
+    bool flagged = !Ready();
+    std::mt19937 rng{1};
+    std::uniform_int_distribution<int32_t> shunt{-SHUNT_FULL_SCALE_UV, SHUNT_FULL_SCALE_UV};
+    std::uniform_int_distribution<int32_t> bus{0, BUS_FULL_SCALE_MV};
+    size_t mismatches{};
+    uint32_t readTransfers{};
+    for(size_t conversion{}; conversion < CONVERSIONS; ++conversion) {
+        std::array<Monitor::Raw, Monitor::CHANNELS_NUM> expected;
+        for(size_t ch{}; ch < Monitor::CHANNELS_NUM; ++ch) {
+            auto uv = shunt(rng), mv = bus(rng);
+            monitor.SetChannel(ch, uv, mv);
+            expected[ch] = {int16_t(uv / Monitor::SHUNT_UV_PER_LSB), int16_t(mv / Monitor::BUS_MV_PER_LSB)};
+        }
+        monitor.Convert();
+        flagged = flagged && Ready() && !Ready();
+        Monitor::Results results;
+        auto transfers = monitor.Transfers();
+        if(Monitor::Read(results) != Drivers::Status::Success) {
+            ++mismatches;
+            continue;
+        }
+        readTransfers = monitor.Transfers() - transfers;
+        for(size_t ch{}; ch < Monitor::CHANNELS_NUM; ++ch) {
+            mismatches += Monitor::ShuntMicrovolts(results[ch]) != expected[ch].shunt * Monitor::SHUNT_UV_PER_LSB ||
+                          Monitor::BusMillivolts(results[ch]) != expected[ch].bus * Monitor::BUS_MV_PER_LSB;
+        }
+    }
+    // Each transfer of a read fails in turn
+    size_t missedErrors{};
+    for(uint32_t passFirst{}; passFirst < readTransfers; ++passFirst) {
+        Monitor::Results results;
+        monitor.FailTransfers(1, passFirst);
+        missedErrors += Monitor::Read(results) == Drivers::Status::Success;
+        missedErrors += Monitor::Read(results) != Drivers::Status::Success;
+    }
+    std::fprintf(stderr,
+                 "ina3221: foreign device %s, configuration %s, ready flag %s, %zu conversions, %zu mismatches, "
+                 "%u transfers a read, %zu missed bus errors\n",
+                 refused ? "refused" : "taken",
+                 configured ? "written" : "wrong",
+                 flagged ? "once per conversion" : "wrong",
+                 CONVERSIONS,
+                 mismatches,
+                 readTransfers,
+                 missedErrors);
+    return refused && configured && flagged && !mismatches && !missedErrors ? EXIT_SUCCESS : EXIT_FAILURE;
+}
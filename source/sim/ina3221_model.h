@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INA3221_MODEL_H
+#define INA3221_MODEL_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Sim {
+
+/**
+ * @brief INA3221 as seen from the I2C bus: a pointer byte alone or followed by the value to write, the reads
+ * repeat the pointed register as the pointer doesn't move. The values set for the channels reach the result
+ * registers on a conversion, which sets the ready flag in the continuous mode; reading the mask/enable register
+ * clears it. The transfers may be failed on request.
+ */
+class Ina3221Model
+{
+public:
+    static constexpr uint8_t ADDRESS = 0x40;
+    static constexpr size_t CHANNELS = 3;
+    static constexpr uint16_t RESET_CONFIG = 0x7127;
+    static constexpr uint16_t DIE_ID = 0x3220;
+
+    explicit Ina3221Model(uint16_t dieId = DIE_ID) : dieId_{dieId}
+    { }
+
+    bool Transfer(uint8_t address, const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen)
+    {
+        if(address != ADDRESS) {
+            return false;
+        }
+        if(transfersToPass_) {
+            --transfersToPass_;
+        }
+        else if(transfersToFail_) {
+            --transfersToFail_;
+            return false;
+        }
+        ++transfers_;
+        if(txLen) {
+            pointer_ = tx[0];
+        }
+        if(txLen == 3 && pointer_ == R_CONFIG) {
+            config_ = uint16_t(tx[1] << 8 | tx[2]);
+        }
+        else if(txLen > 1) {
+            return false;
+        }
+        if(rxLen) {
+            auto value = Read(pointer_);
+            for(size_t i{}; i < rxLen; ++i) {
+                rx[i] = i % 2 ? uint8_t(value) : uint8_t(value >> 8);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief The input of a channel for the next conversion, clipped to the full scale as the device does
+     */
+    void SetChannel(size_t ch, int32_t shuntMicrovolts, int32_t busMillivolts)
+    {
+        pendingShunt_[ch] = Encode(shuntMicrovolts / SHUNT_UV_PER_LSB);
+        pendingBus_[ch] = Encode(busMillivolts / BUS_MV_PER_LSB);
+    }
+
+    void Convert()
+    {
+        for(size_t ch{}; ch < CHANNELS; ++ch) {
+            if(config_ & (1U << (14 - ch))) {
+                shunt_[ch] = pendingShunt_[ch];
+                bus_[ch] = pendingBus_[ch];
+            }
+        }
+        ready_ = (config_ & MODE_MASK) == MODE_CONTINUOUS;
+    }
+
+    /**
+     * @brief Fail the transfers after the given number of the successful ones
+     */
+    void FailTransfers(size_t count, size_t passFirst = 0)
+    {
+        transfersToFail_ = count;
+        transfersToPass_ = passFirst;
+    }
+
+    uint16_t Config() const
+    {
+        return config_;
+    }
+
+    uint32_t Transfers() const
+    {
+        return transfers_;
+    }
+private:
+    static constexpr int32_t SHUNT_UV_PER_LSB = 40;
+    static constexpr int32_t BUS_MV_PER_LSB = 8;
+    static constexpr uint8_t R_CONFIG = 0x00;
+    static constexpr uint8_t R_MASK_ENABLE = 0x0F;
+    static constexpr uint16_t MODE_MASK = 0b111;
+    static constexpr uint16_t MODE_CONTINUOUS = 0b111;
+
+    // 13 bit two's complement, left aligned
+    static uint16_t Encode(int32_t lsbs)
+    {
+        return uint16_t(std::clamp(lsbs, -4096, 4095) * 8);
+    }
+
+    uint16_t Read(uint8_t reg)
+    {
+        if(reg >= 0x01 && reg <= 0x06) {
+            auto ch = size_t(reg - 1) / 2;
+            return reg % 2 ? shunt_[ch] : bus_[ch];
+        }
+        switch(reg) {
+            case R_CONFIG: return config_;
+            case R_MASK_ENABLE: {
+                uint16_t mask = ready_ ? 1 : 0;
+                ready_ = false;
+                return mask;
+            }
+            case 0xFE: return 0x5449;
+            case 0xFF: return dieId_;
+            default: return 0;
+        }
+    }
+
+    uint16_t dieId_;
+    uint16_t config_{RESET_CONFIG};
+    uint8_t pointer_{};
+    bool ready_{};
+    std::array<uint16_t, CHANNELS> pendingShunt_{}, pendingBus_{}, shunt_{}, bus_{};
+    size_t transfersToFail_{};
+    size_t transfersToPass_{};
+    uint32_t transfers_{};
+};
+
+} // Sim
+
+#endif // INA3221_MODEL_H
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "input_handler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/**
+ * The key scanner on bounce traces: the raw key bits sampled every KEY_SCAN_MS as the scan thread does.
+ * A change of a key is its edges up to a stable level, one that holds for the debounce time at least; the ones
+ * which come back to the previous level are glitches. Every change must give a single event, within the
+ * debounce time of the last edge, the glitches none. The long taps and the repeats are checked on the single
+ * key presses.
+ */
+
+using namespace Input;
+
+constexpr uint64_t SCAN_US = KEY_SCAN_MS * 1000;
+constexpr uint64_t DEBOUNCE_US = 4 * SCAN_US;
+constexpr uint64_t LONG_TAP_US = LONG_TAP_MS * 1000;
+
+// The raw key bits from that time on
+struct Edge
+{
+    uint64_t us;
+    raw_event_t raw;
+};
+
+struct KeyEdge
+{
+    uint64_t us;
+    size_t key;
+    bool level;
+};
+
+struct Change
+{
+    bool pressed;
+    uint64_t first;
+    uint64_t last;
+};
+
+// Presses of single keys and of chords with the contact bounce, and the noise spikes shorter than a scan
+static std::vector<Edge> SyntheticTrace()
+{
+    constexpr size_t TRIALS = 2000;
+    constexpr uint64_t MAX_BOUNCE_GAP_US = 1500;
+    std::mt19937 rng{1};
+    std::vector<KeyEdge> keyEdges;
+    auto bounce = [&](size_t key, bool level, uint64_t at) {
+        for(auto edges = rng() % 8; edges; --edges) {
+            keyEdges.push_back({at, key, edges % 2 ? level : !level});
+            at += rng() % MAX_BOUNCE_GAP_US + 1;
+        }
+        keyEdges.push_back({at, key, level});
+        return at;
+    };
+    uint64_t time = 10'000;
+    for(size_t trial{}; trial < TRIALS; ++trial) {
+        auto key = rng() % KeyScanner::KEYS_NUM;
+        if(rng() % 8 == 0) {
+            keyEdges.push_back({time, key, true});
+            keyEdges.push_back({time + rng() % (SCAN_US - 100) + 50, key, false});
+            time += 50'000;
+            continue;
+        }
+        std::vector<size_t> keys{key};
+        if(rng() % 5 == 0) {
+            keys.push_back((key + 1 + rng() % (KeyScanner::KEYS_NUM - 1)) % KeyScanner::KEYS_NUM);
+        }
+        uint64_t end{};
+        for(auto pressed : keys) {
+            auto at = time + (pressed == key ? 0 : rng() % 20'000);
+            auto hold = 40'000 + rng() % 1'500'000;
+            end = std::max(end, bounce(pressed, false, bounce(pressed, true, at) + hold));
+        }
+        time = end + 60'000 + rng() % 200'000;
+    }
+    std::stable_sort(keyEdges.begin(), keyEdges.end(), [](const auto& a, const auto& b) { return a.us < b.us; });
+    std::vector<Edge> trace;
+    raw_event_t raw{};
+    for(const auto& edge : keyEdges) {
+        raw = edge.level ? raw | (1U << edge.key) : raw & ~(1U << edge.key);
+        trace.push_back({edge.us, raw});
+    }
+    return trace;
+}
+
+// The changes of a key, the edges closer than the debounce time are one change or a glitch
+static std::vector<Change> ChangesOf(const std::vector<Edge>& trace, size_t key, size_t& glitches)
+{
+    std::vector<Change> changes;
+    bool level{}, stable{};
+    Change current{};
+    bool open{};
+    for(const auto& edge : trace) {
+        bool bit = edge.raw & (1U << key);
+        if(bit == level) {
+            continue;
+        }
+        if(open && edge.us - current.last >= DEBOUNCE_US) {
+            if(level != stable) {
+                changes.push_back({level, current.first, current.last});
+                stable = level;
+            }
+            else {
+                ++glitches;
+            }
+            open = false;
+        }
+        if(!open) {
+            current.first = edge.us;
+            open = true;
+        }
+        current.last = edge.us;
+        level = bit;
+    }
+    if(open) {
+        if(level != stable) {
+            changes.push_back({level, current.first, current.last});
+        }
+        else {
+            ++glitches;
+        }
+    }
+    return changes;
+}
+
+static bool ReadTrace(const char* path, std::vector<Edge>& trace)
+{
+    auto* file = std::fopen(path, "r");
+    if(!file) {
+        std::fprintf(stderr, "Can't read %s\n", path);
+        return false;
+    }
+    unsigned long long us;
+    unsigned raw;
+    while(std::fscanf(file, "%llu %x", &us, &raw) == 2) {
+        trace.push_back({us, raw_event_t(raw)});
+    }
+    std::fclose(file);
+    return true;
+}
+
+int CheckKeys(const char* tracePath)
+{
+    std::vector<Edge> trace;
+    if(tracePath) {
+        if(!ReadTrace(tracePath, trace)) {
+            return EXIT_FAILURE;
+        }
+    }
+    else {
+        trace = SyntheticTrace();
+    }
+    if(trace.empty()) {
+        std::fprintf(stderr, "keys: empty trace\n");
+        return EXIT_FAILURE;
+    }
+    std::vector<KeyEvent> events;
+    KeyScanner scanner;
+    size_t next{};
+    raw_event_t raw{};
+    auto end = trace.back().us + 2 * LONG_TAP_US;
+    for(uint64_t scan{}; scan * SCAN_US <= end; ++scan) {
+        while(next < trace.size() && trace[next].us <= scan * SCAN_US) {
+            raw = trace[next++].raw;
+        }
+        scanner.Process(raw, systime_t(TIME_MS2I(scan * KEY_SCAN_MS)), [&](const KeyEvent& event) {
+            events.push_back(event);
+        });
+    }
+    size_t changesNum{}, glitches{}, missed{}, extra{}, late{}, tapErrors{};
+    double fromFirstSum{};
+    uint64_t fromFirstMax{}, fromLastMax{};
+    for(size_t key{}; key < KeyScanner::KEYS_NUM; ++key) {
+        auto changes = ChangesOf(trace, key, glitches);
+        changesNum += changes.size();
+        size_t change{};
+        uint64_t pressedAt{};
+        bool single{};
+        uint16_t longs{}, repeats{};
+        for(const auto& event : events) {
+            if(event.key != KeyScanner::KEY_MAP[key]) {
+                continue;
+            }
+            auto us = uint64_t(TIME_I2MS(event.time)) * 1000;
+            if(event.action == Action::LONG || event.action == Action::REPEAT) {
+                longs += event.action == Action::LONG;
+                // Numbered from one, the long tap carries none
+                tapErrors += !single || event.repeats != (event.action == Action::LONG ? 0 : ++repeats);
+                continue;
+            }
+            bool pressed = event.action != Action::RELEASE;
+            if(change == changes.size() || changes[change].pressed != pressed || us < changes[change].first) {
+                ++extra;
+                continue;
+            }
+            const auto& matched = changes[change++];
+            fromFirstSum += double(us - matched.first);
+            fromFirstMax = std::max(fromFirstMax, us - matched.first);
+            auto fromLast = us > matched.last ? us - matched.last : 0;
+            fromLastMax = std::max(fromLastMax, fromLast);
+            late += fromLast > DEBOUNCE_US;
+            if(pressed) {
+                pressedAt = us;
+                single = event.action == Action::PRESS;
+                longs = repeats = 0;
+            }
+            else if(single && !event.chord) {
+                // The long tap is due on the scan LONG_TAP_MS after the press, unless the release comes with it
+                tapErrors += longs != (us - pressedAt > LONG_TAP_US) || event.repeats != repeats;
+            }
+        }
+        missed += changes.size() - change;
+    }
+    std::fprintf(stderr,
+                 "keys: %zu changes, %zu glitches, %zu missed, %zu extra events, latency from the first edge "
+                 "%.1f ms mean, %.1f ms max, from the last %.1f ms max, %zu over the debounce time, "
+                 "%zu long tap errors\n",
+                 changesNum,
+                 glitches,
+                 missed,
+                 extra,
+                 changesNum ? fromFirstSum / 1000 / double(changesNum) : 0.0,
+                 double(fromFirstMax) / 1000,
+                 double(fromLastMax) / 1000,
+                 late,
+                 tapErrors);
+    return missed || extra || late || tapErrors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
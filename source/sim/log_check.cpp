@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "chlog.h"
+#include "frame.h"
+#include "telemetry.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/**
+ * The deferred log of the firmware with the simulation acting for the threads: the drain keeps the time
+ * order across the rings even for a record pushed while it runs, the threads past the rings are counted,
+ * and the cost of a record is measured against formatting it in place. The records go to the capture
+ * as the telemetry frames, tools/telemetry.py --elf jbc_sim decodes them.
+ */
+
+using DeferredLog::word_t;
+
+static std::vector<std::vector<word_t>> drained;
+static FILE* capture;
+static uint8_t seq;
+
+static bool Collect(const word_t* record, size_t words)
+{
+    drained.emplace_back(record, record + words);
+    if(capture) {
+        uint8_t frame[Utils::MaxFrameSize((DeferredLog::MAX_ARGS + 3) * sizeof(word_t))];
+        auto len =
+          Utils::EncodeFrame(frame, sizeof(frame), Telemetry::FRAME_LOG, seq++, record, words * sizeof(word_t));
+        std::fwrite(frame, 1, len, capture);
+    }
+    return true;
+}
+
+static thread_t threads[DeferredLog::MAX_WRITERS + 2];
+
+static void RunAs(thread_t& thread, auto&& body)
+{
+    Sim::currentThread = &thread;
+    body();
+    Sim::currentThread = &Sim::mainThread;
+}
+
+// A thread preempts the log thread while it drains and logs a record newer than the drain start
+static bool lateRecordPending;
+
+static bool CollectAndPreempt(const word_t* record, size_t words)
+{
+    if(lateRecordPending) {
+        lateRecordPending = false;
+        ++Sim::systemTime;
+        RunAs(threads[2], [] { CHLOG("late record from thread %u", 3U); });
+    }
+    return Collect(record, words);
+}
+
+static bool CheckOrder()
+{
+    DeferredLog::init(CollectAndPreempt);
+    Sim::systemTime = 100;
+    RunAs(threads[0], [] { CHLOG("thread %u, %s", 1U, "first"); });
+    ++Sim::systemTime;
+    RunAs(threads[1], [] { CHLOG("thread %u, %s", 2U, "second"); });
+    ++Sim::systemTime;
+    RunAs(threads[0], [] { CHLOG("thread %u, %s, %d args", 1U, "third", 3); });
+    lateRecordPending = true;
+    DeferredLog::Drain();
+    DeferredLog::Drain();
+    bool ordered = drained.size() == 4;
+    for(size_t i{1}; i < drained.size(); ++i) {
+        ordered = ordered && drained[i][0] >= drained[i - 1][0];
+    }
+    std::fprintf(stderr, "log: %zu records drained %s\n", drained.size(), ordered ? "in order" : "out of order");
+    return ordered;
+}
+
+static bool CheckUnbound()
+{
+    auto before = DeferredLog::GetStats();
+    for(auto& thread : threads) {
+        RunAs(thread, [] { CHLOG("bound"); });
+    }
+    DeferredLog::Drain();
+    auto after = DeferredLog::GetStats();
+    // The order check bound the first three, all the rings are taken before the last two
+    auto unbound = after.unbound - before.unbound;
+    std::fprintf(stderr,
+                 "log: %zu threads for %zu rings, %u records unbound, %u dropped\n",
+                 std::size(threads),
+                 DeferredLog::MAX_WRITERS,
+                 unbound,
+                 after.dropped - before.dropped);
+    return unbound == std::size(threads) - DeferredLog::MAX_WRITERS && after.dropped - before.dropped == unbound;
+}
+
+// A record in the control loop costs the push only, the drain runs in the log thread
+static void Benchmark()
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr size_t RECORDS = 1'000'000;
+    constexpr size_t BATCH = 8;
+    static constexpr char FORMAT[] = "control: iron %u cut off at %d C";
+    DeferredLog::init([](const word_t*, size_t) { return true; });
+    Sim::currentThread = &threads[0];
+    Clock::duration push{}, drain{}, format{};
+    char line[128];
+    size_t chars{};
+    for(size_t i{}; i < RECORDS; i += BATCH) {
+        auto start = Clock::now();
+        for(size_t j{}; j < BATCH; ++j) {
+            CHLOG(FORMAT, unsigned(j % 3) + 1, int(i + j));
+        }
+        auto pushed = Clock::now();
+        DeferredLog::Drain();
+        auto drainedAt = Clock::now();
+        for(size_t j{}; j < BATCH; ++j) {
+            chars += size_t(std::snprintf(line, sizeof(line), FORMAT, unsigned(j % 3) + 1, int(i + j)));
+        }
+        push += pushed - start;
+        drain += drainedAt - pushed;
+        format += Clock::now() - drainedAt;
+    }
+    Sim::currentThread = &Sim::mainThread;
+    auto perRecord = [](Clock::duration total) {
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(total).count()) / RECORDS;
+    };
+    std::fprintf(stderr,
+                 "log: %zu records, push %.1f ns, drain %.1f ns, snprintf in place %.1f ns per record (%zu chars)\n",
+                 RECORDS,
+                 perRecord(push),
+                 perRecord(drain),
+                 perRecord(format),
+                 chars);
+}
+
+int CheckLog(const char* capturePath)
+{
+    if(capturePath && !(capture = std::fopen(capturePath, "wb"))) {
+        std::fprintf(stderr, "log: can't open %s\n", capturePath);
+        return EXIT_FAILURE;
+    }
+    bool ordered = CheckOrder();
+    bool unbound = CheckUnbound();
+    if(capture) {
+        std::fclose(capture);
+        capture = nullptr;
+    }
+    Benchmark();
+    return ordered && unbound ? EXIT_SUCCESS : EXIT_FAILURE;
+}
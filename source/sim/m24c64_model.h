@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef M24C64_MODEL_H
+#define M24C64_MODEL_H
+
+#include "ch.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Sim {
+
+/**
+ * @brief M24C64 as seen from the I2C bus: two address bytes, then the data to write or a sequential read.
+ * A write rolls over within its page and makes the device ignore its address for the write cycle.
+ * The cycle is counted from the tick the write ended in, the worst case of where in the tick it was.
+ * Counts the write cycles of every page, the reads may be failed and a write torn on request.
+ */
+class M24c64Model
+{
+public:
+    static constexpr uint8_t ADDRESS = 0x50;
+    static constexpr size_t SIZE = 8192;
+    static constexpr size_t PAGE_SIZE = 32;
+    static constexpr uint32_t WRITE_CYCLE_MS = 5;
+
+    M24c64Model()
+    {
+        memory_.fill(0xFF);
+    }
+
+    bool Transfer(uint8_t address, const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen)
+    {
+        if(address != ADDRESS || txLen < 2) {
+            return false;
+        }
+        if(chVTGetSystemTimeX() < busyUntil_) {
+            ++busyNacks_;
+            return false;
+        }
+        auto start = size_t(tx[0] << 8 | tx[1]) % SIZE;
+        if(rxLen) {
+            if(readsToPass_) {
+                --readsToPass_;
+            }
+            else if(readsToFail_) {
+                --readsToFail_;
+                return false;
+            }
+            for(size_t i{}; i < rxLen; ++i) {
+                rx[i] = memory_[(start + i) % SIZE];
+            }
+            return true;
+        }
+        auto len = std::min(txLen - 2, tearAfter_);
+        tearAfter_ = SIZE;
+        auto page = start / PAGE_SIZE;
+        for(size_t i{}; i < len; ++i) {
+            memory_[page * PAGE_SIZE + (start + i) % PAGE_SIZE] = tx[2 + i];
+        }
+        ++pageWrites_[page];
+        busyUntil_ = chVTGetSystemTimeX() + TIME_MS2I(WRITE_CYCLE_MS + 1);
+        return true;
+    }
+
+    /**
+     * @brief Fail the reads after the given number of the successful ones
+     */
+    void FailReads(size_t count, size_t passFirst = 0)
+    {
+        readsToFail_ = count;
+        readsToPass_ = passFirst;
+    }
+
+    /**
+     * @brief Only the first bytes of the next write reach the memory, as if the power went off during it
+     */
+    void TearNextWrite(size_t bytes)
+    {
+        tearAfter_ = bytes;
+    }
+
+    const std::array<uint32_t, SIZE / PAGE_SIZE>& PageWrites() const
+    {
+        return pageWrites_;
+    }
+
+    uint32_t BusyNacks() const
+    {
+        return busyNacks_;
+    }
+private:
+    std::array<uint8_t, SIZE> memory_;
+    std::array<uint32_t, SIZE / PAGE_SIZE> pageWrites_{};
+    systime_t busyUntil_{};
+    uint32_t busyNacks_{};
+    size_t readsToFail_{};
+    size_t readsToPass_{};
+    size_t tearAfter_{SIZE};
+};
+
+} // Sim
+
+#endif // M24C64_MODEL_H
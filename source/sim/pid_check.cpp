@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "fixed_point.h"
+#include "heater.h"
+#include "pid.h"
+#include "sensor_handler.h"
+#include "temp_control.h"
+#include "thermal_model.h"
+#include "thermocouple.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/**
+ * The PID engine alone on the cartridge models, with the default gains in both arithmetics: a heat-up from
+ * the ambient, then a steady load on the tip. The measurement goes through the thermocouple counts as on the
+ * target. Checks the overshoot, the settle and recovery times and how far Q16 strays from float, and times
+ * an update of each.
+ */
+
+using namespace Drivers;
+
+constexpr float DT = float(Heater::PERIOD * Sensors::BLOCK_SCANS) / Heater::TICK_FREQUENCY;
+constexpr float PERIOD_SECONDS = float(Heater::PERIOD) / Heater::TICK_FREQUENCY;
+// The full duty of the control step is the on-region with the default settle time
+constexpr float MAX_ON_FRACTION =
+  float(Heater::SAMPLING_TICKS - Heater::DEFAULT_SETTLE_TICKS - Heater::MIN_START) / Heater::PERIOD;
+constexpr float VIN_NOMINAL = 24.0f;
+constexpr float SETPOINT = 350.0f;
+constexpr float SETTLE_BAND = 2.0f;
+constexpr float SECONDS = 30.0f;
+constexpr float LOAD_START = 20.0f;
+// Of the rated power, a large joint
+constexpr float LOAD_FRACTION = 0.3f;
+
+constexpr float MAX_OVERSHOOT = 15.0f;
+constexpr float MAX_SETTLE_SECONDS = 16.0f;
+constexpr float MAX_RECOVERY_SECONDS = 5.0f;
+constexpr float MAX_Q16_DEVIATION = 2.0f;
+
+struct Case
+{
+    const char* name;
+    Control::TipProfile tip;
+    Sim::IronModel::Params model;
+    const Thermocouple::Table* table;
+    float vin;
+};
+
+// A sagging supply only slows the heat-up down, the feed-forward keeps the response under the load
+static const Case CASES[] = {
+  {"T245", Control::T245_DEFAULTS, Sim::T245_MODEL, &Thermocouple::T245, VIN_NOMINAL},
+  {"T245 at 21 V", Control::T245_DEFAULTS, Sim::T245_MODEL, &Thermocouple::T245, 21.0f},
+  {"C210", Control::C210_DEFAULTS, Sim::C210_MODEL, &Thermocouple::C210, VIN_NOMINAL},
+  {"C210 at 21 V", Control::C210_DEFAULTS, Sim::C210_MODEL, &Thermocouple::C210, 21.0f},
+};
+
+struct Response
+{
+    std::vector<float> temperatures; // Of the tip, a control step each
+    float overshoot;
+    float settledAt;
+    float droop;
+    float recovery;
+};
+
+template<typename T>
+static Response Run(const Case& test)
+{
+    Math::Pid<T> pid{{.kp = test.tip.kp, .ki = test.tip.ki, .kd = test.tip.kd}, DT};
+    Sim::IronModel model{test.model};
+    auto ambient = test.model.ambient;
+    auto supply = (test.vin * test.vin) / (VIN_NOMINAL * VIN_NOMINAL);
+    const T ffGain{1.0f / supply};
+    Response response{};
+    auto steps = size_t(SECONDS / DT);
+    response.temperatures.reserve(steps);
+    for(size_t step{}; step < steps; ++step) {
+        auto time = float(step) * DT;
+        auto counts = Thermocouple::CountsFor(*test.table, model.SensorTemperature() - ambient);
+        auto measured = ambient + float((*test.table)(counts));
+        auto duty = float(pid.Update(T(SETPOINT), T(measured), ffGain));
+        auto watts = test.tip.maxPower * supply * duty * MAX_ON_FRACTION;
+        auto load = time >= LOAD_START ? test.tip.maxPower * LOAD_FRACTION : 0.0f;
+        for(size_t scan{}; scan < Sensors::BLOCK_SCANS; ++scan) {
+            model.Step(watts, load, PERIOD_SECONDS);
+        }
+        auto temperature = model.Temperature();
+        response.temperatures.push_back(temperature);
+        bool outside = std::abs(temperature - SETPOINT) > SETTLE_BAND;
+        if(time < LOAD_START) {
+            response.overshoot = std::max(response.overshoot, temperature - SETPOINT);
+            response.settledAt = outside ? time + DT : response.settledAt;
+        }
+        else {
+            response.droop = std::max(response.droop, SETPOINT - temperature);
+            response.recovery = outside ? time + DT - LOAD_START : response.recovery;
+        }
+    }
+    return response;
+}
+
+// Update time with a measurement around the setpoint, the setpoint and the gain converted once as the control does
+template<typename T>
+static double UpdateNs()
+{
+    constexpr size_t UPDATES = 2'000'000;
+    const auto& tip = Control::T245_DEFAULTS;
+    Math::Pid<T> pid{{.kp = tip.kp, .ki = tip.ki, .kd = tip.kd}, DT};
+    std::mt19937 rng{1};
+    std::uniform_real_distribution<float> around{SETPOINT - 10.0f, SETPOINT + 10.0f};
+    std::array<T, 256> measurements;
+    std::generate(measurements.begin(), measurements.end(), [&] { return T(around(rng)); });
+    const T setpoint{SETPOINT}, ffGain{1.1f};
+    [[maybe_unused]] volatile float sink{};
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i{}; i < UPDATES; ++i) {
+        sink = float(pid.Update(setpoint, measurements[i % measurements.size()], ffGain));
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / UPDATES;
+}
+
+int CheckPid()
+{
+    size_t failures{};
+    float worstDeviation{};
+    for(const auto& test : CASES) {
+        auto reference = Run<float>(test);
+        auto fixed = Run<Math::Q16>(test);
+        for(const auto* response : {&reference, &fixed}) {
+            bool ok = response->overshoot <= MAX_OVERSHOOT && response->settledAt <= MAX_SETTLE_SECONDS &&
+                      response->recovery <= MAX_RECOVERY_SECONDS;
+            failures += !ok;
+            std::fprintf(stderr,
+                         "pid %s %s: overshoot %.1f C, settled in %.2f s, load droop %.1f C, recovered in %.2f s%s\n",
+                         test.name,
+                         response == &reference ? "float" : "Q16",
+                         double(response->overshoot),
+                         double(response->settledAt),
+                         double(response->droop),
+                         double(response->recovery),
+                         ok ? "" : ", out of the limits");
+        }
+        for(size_t step{}; step < reference.temperatures.size(); ++step) {
+            worstDeviation =
+              std::max(worstDeviation, std::abs(reference.temperatures[step] - fixed.temperatures[step]));
+        }
+    }
+    failures += worstDeviation > MAX_Q16_DEVIATION;
+    // Host figures, the M4 runs the Q16 products as long multiplies and float on its single precision FPU
+    std::fprintf(stderr,
+                 "pid: update float %.2f ns, Q16 %.2f ns on the host, Q16 off the float by %.2f C at most\n",
+                 UpdateNs<float>(),
+                 UpdateNs<Math::Q16>(),
+                 double(worstDeviation));
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
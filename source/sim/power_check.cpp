@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "heater.h"
+#include "heater_timer_model.h"
+#include "power_scheduler.h"
+#include "temp_control.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+/**
+ * The supply current of the three heaters as the driver switches them on the timer model, with the on-times
+ * of the power scheduler and with the requested ones all started at the beginning of the on-region, as they
+ * were before it. Reports the peak and the period mean for a few station states and checks the peaks against
+ * the budget, then checks the budget, the overlaps and the priority of the iron in use on random demands.
+ */
+
+using namespace Drivers;
+
+constexpr float VIN = 24.0f;
+constexpr float FULL_POWER[Heater::CHANNELS_NUM] = {
+  Control::T245_DEFAULTS.maxPower, Control::T245_DEFAULTS.maxPower, Control::C210_DEFAULTS.maxPower};
+
+struct Scenario
+{
+    const char* name;
+    std::array<float, Heater::CHANNELS_NUM> duties;
+    uint32_t inUseMask;
+};
+
+// Iron 1 out of the stand
+static const Scenario SCENARIOS[] = {
+  {"all cold", {1.0f, 1.0f, 1.0f}, 0b001},
+  {"iron 1 heats, the others hold", {1.0f, 0.15f, 0.25f}, 0b001},
+  {"iron 1 works, the others hold", {0.45f, 0.15f, 0.25f}, 0b001},
+  {"all hold", {0.2f, 0.15f, 0.25f}, 0b001},
+};
+
+struct Current
+{
+    float peak;
+    float mean;
+    bool overlap;
+};
+
+static Current Measure(Sim::HeaterTimerModel& timer)
+{
+    // The pending on-times are taken at the period start
+    auto period = timer.Run();
+    Current current{};
+    for(auto outputs : period.outputs) {
+        float amps{};
+        for(uint32_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+            amps += outputs & (1U << ch) ? FULL_POWER[ch] / VIN : 0.0f;
+        }
+        current.peak = std::max(current.peak, amps);
+        current.mean += amps / Heater::PERIOD;
+        current.overlap = current.overlap || std::popcount(outputs) > 1;
+    }
+    return current;
+}
+
+static Power::Demands DemandsOf(const std::array<float, Heater::CHANNELS_NUM>& duties, uint32_t inUseMask)
+{
+    Power::Demands demands;
+    for(uint32_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        demands[ch] = {.duty = duties[ch], .fullPower = FULL_POWER[ch], .inUse = bool(inUseMask & (1U << ch))};
+    }
+    return demands;
+}
+
+static Current Unscheduled(Sim::HeaterTimerModel& timer, const Power::Demands& demands, uint32_t maxTicks)
+{
+    for(uint32_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        Heater::SetOnTime(Heater::Channel(ch), 0, uint32_t(std::clamp(demands[ch].duty, 0.0f, 1.0f) * maxTicks));
+    }
+    return Measure(timer);
+}
+
+static Current Scheduled(Sim::HeaterTimerModel& timer, const Power::Slots& slots)
+{
+    for(uint32_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        Heater::SetOnTime(Heater::Channel(ch), slots[ch].start, slots[ch].ticks);
+    }
+    return Measure(timer);
+}
+
+int CheckPower()
+{
+    constexpr size_t RUNS = 20'000;
+    Heater::Init();
+    Sim::HeaterTimerModel timer;
+    auto maxTicks = Heater::GetMaxDuty();
+    // A little slack for the float sums
+    constexpr float PEAK_LIMIT = Power::BUDGET_WATTS / VIN * 1.0001f;
+    size_t peaksOver{};
+    for(const auto& scenario : SCENARIOS) {
+        auto demands = DemandsOf(scenario.duties, scenario.inUseMask);
+        auto before = Unscheduled(timer, demands, maxTicks);
+        auto after = Scheduled(timer, Power::Schedule(demands, maxTicks));
+        std::fprintf(stderr,
+                     "power %s: peak %.1f A, mean %.1f A unscheduled, peak %.1f A, mean %.1f A scheduled\n",
+                     scenario.name,
+                     double(before.peak),
+                     double(before.mean),
+                     double(after.peak),
+                     double(after.mean));
+        peaksOver += after.peak > PEAK_LIMIT;
+    }
+    std::mt19937 rng{1};
+    std::uniform_real_distribution<float> duty{0.0f, 1.0f};
+    size_t overBudget{}, avoidableOverlaps{}, cutInUse{};
+    for(size_t run{}; run < RUNS; ++run) {
+        // A quarter of the irons idle, to get the sums that fit into the period
+        std::array<float, Heater::CHANNELS_NUM> duties;
+        std::generate(duties.begin(), duties.end(), [&] { return rng() % 4 ? duty(rng) * duty(rng) : 0.0f; });
+        auto demands = DemandsOf(duties, rng() % (1U << Heater::CHANNELS_NUM));
+        auto slots = Power::Schedule(demands, maxTicks);
+        uint32_t ticks{};
+        float watts{}, inUsePower{};
+        for(uint32_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+            ticks += slots[ch].ticks;
+            watts += float(slots[ch].ticks) / maxTicks * FULL_POWER[ch];
+            inUsePower += demands[ch].inUse ? FULL_POWER[ch] : 0.0f;
+        }
+        overBudget += watts > Power::BUDGET_WATTS * 1.0001f;
+        auto after = Scheduled(timer, slots);
+        avoidableOverlaps += ticks <= maxTicks && after.overlap;
+        peaksOver += after.peak > PEAK_LIMIT;
+        // The irons in use get all they ask for while they fit the budget together, whatever the stand-by ones want
+        for(uint32_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+            cutInUse += inUsePower <= Power::BUDGET_WATTS && demands[ch].inUse &&
+                        slots[ch].ticks != uint32_t(demands[ch].duty * maxTicks);
+        }
+    }
+    std::fprintf(stderr,
+                 "power: %zu random demands, %zu over the %.0f W budget, %zu overlaps that fit apart, "
+                 "%zu peaks above %.1f A, %zu irons in use cut\n",
+                 RUNS,
+                 overBudget,
+                 double(Power::BUDGET_WATTS),
+                 avoidableOverlaps,
+                 peaksOver,
+                 double(PEAK_LIMIT),
+                 cutInUse);
+    return overBudget || avoidableOverlaps || peaksOver || cutInUse ? EXIT_FAILURE : EXIT_SUCCESS;
+}
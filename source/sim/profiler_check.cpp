@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "hal_streams.h"
+#include "profiler.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * The profiler report on threads declared to the host registry with known cycle counts and stack use, and
+ * on interrupts timed by the realtime counter: the loads are the shares of the cycles since the previous
+ * report, a nested interrupt counts within the outer one, the counter may wrap inside an interrupt, a thread
+ * started between the reports counts from zero and the ones over the table size are left out.
+ */
+
+extern "C" void profIrqEnter(void);
+extern "C" void profIrqExit(void);
+
+constexpr size_t STACK_SIZE = 1024;
+constexpr size_t MAX_ROWS = 16;
+
+struct FakeThread
+{
+    uint8_t stack[STACK_SIZE];
+    thread_t thread;
+};
+
+static FakeThread threads[MAX_ROWS + 2];
+static std::string names[MAX_ROWS + 2];
+
+struct Row
+{
+    std::string name;
+    uint32_t permille;
+    uint32_t value; // Free stack bytes, the interrupt count for the irq row
+
+    bool operator==(const Row&) const = default;
+};
+
+// The stack grows down to the base, the bytes it never reached keep the fill value
+static void Start(size_t index, uint32_t used, rttime_t cycles)
+{
+    auto& fake = threads[index];
+    std::fill(std::begin(fake.stack), std::end(fake.stack), uint8_t(CH_DBG_STACK_FILL_VALUE));
+    std::fill(std::end(fake.stack) - used, std::end(fake.stack), uint8_t(0));
+    fake.thread.stats.cumulative = cycles;
+    names[index] = "thread" + std::to_string(index);
+    Sim::Register(fake.thread, names[index].c_str(), fake.stack);
+}
+
+static void Interrupt(rtcnt_t enter, rtcnt_t nestedEnter, rtcnt_t nestedExit, rtcnt_t exit)
+{
+    Sim::realtimeCounter = enter;
+    profIrqEnter();
+    Sim::realtimeCounter = nestedEnter;
+    profIrqEnter();
+    Sim::realtimeCounter = nestedExit;
+    profIrqExit();
+    Sim::realtimeCounter = exit;
+    profIrqExit();
+}
+
+// The rows up to the irq one and the period of the header
+static std::vector<Row> Report(uint32_t& periodMs)
+{
+    BaseSequentialStream stream{};
+    Profiler::Report(&stream);
+    std::istringstream lines{stream.output};
+    std::string line;
+    std::vector<Row> rows;
+    periodMs = 0;
+    if(std::getline(lines, line)) {
+        std::sscanf(line.c_str(), "-- %u ms", &periodMs);
+    }
+    std::getline(lines, line);
+    while(std::getline(lines, line)) {
+        char name[32];
+        unsigned whole, tenth, value;
+        if(std::sscanf(line.c_str(), "%31s %u.%u%% %u", name, &whole, &tenth, &value) != 4) {
+            break;
+        }
+        rows.push_back({name, whole * 10 + tenth, value});
+        if(rows.back().name == "irq") {
+            break;
+        }
+    }
+    return rows;
+}
+
+int CheckProfiler()
+{
+    size_t failures{};
+    uint32_t periodMs;
+    Profiler::init();
+    Start(0, 600, 6000);
+    Start(1, 200, 3000);
+    Start(2, 64, 1000);
+    // 300 cycles with a nested one, then 512 across the counter wrap
+    Interrupt(100, 150, 200, 400);
+    Interrupt(0xFFFF'FF00, 0xFFFF'FF80, 0xFFFF'FFC0, 0x100);
+    Sim::systemTime += 500;
+    auto first = Report(periodMs);
+    failures += periodMs != 500 || first != std::vector<Row>{{"thread0", 600, 424},
+                                                           {"thread1", 300, 824},
+                                                           {"thread2", 100, 960},
+                                                           {"irq", 81, 2}};
+    threads[0].thread.stats.cumulative += 1000;
+    threads[2].thread.stats.cumulative += 1000;
+    Start(3, 1024, 2000);
+    Sim::systemTime += 1000;
+    auto second = Report(periodMs);
+    failures += periodMs != 1000 || second != std::vector<Row>{{"thread0", 250, 424},
+                                                             {"thread1", 0, 824},
+                                                             {"thread2", 250, 960},
+                                                             {"thread3", 500, 0},
+                                                             {"irq", 0, 0}};
+    for(size_t index = 4; index < std::size(threads); ++index) {
+        Start(index, 0, 100);
+    }
+    auto third = Report(periodMs);
+    failures += third.size() != MAX_ROWS + 1 || third[MAX_ROWS - 1].name != names[MAX_ROWS - 1];
+    std::fprintf(stderr,
+                 "profiler: %zu threads, %zu rows reported, %zu wrong reports\n",
+                 std::size(threads),
+                 third.size() ? third.size() - 1 : 0,
+                 failures);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
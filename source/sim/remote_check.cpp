@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "frame.h"
+#include "hal.h"
+#include "remote.h"
+#include "stubs.h"
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <optional>
+#include <vector>
+
+/**
+ * The remote protocol of the firmware with the serial port looped back to the simulation: the requests
+ * are fed to the receive path byte by byte and the responses are decoded from what it wrote. The read
+ * commands are open, the setpoint ones wait for the PIN and the wrong PINs lock it out for a while.
+ */
+
+static_assert(REMOTE_PIN != 0, "The simulator build sets a PIN to unlock with");
+
+using Remote::Command;
+using Remote::Result;
+
+static uint8_t seq;
+static size_t failures;
+
+// The response payload, nothing if no valid response came
+static std::optional<std::vector<uint8_t>> Feed(const uint8_t* bytes, size_t len, uint8_t type)
+{
+    Sim::serialOut.clear();
+    for(size_t i{}; i < len; ++i) {
+        Remote::Receive(bytes[i]);
+    }
+    if(Sim::serialOut.empty() || Sim::serialOut.back()) {
+        return {};
+    }
+    auto response = Utils::DecodeFrame(Sim::serialOut.data(), Sim::serialOut.size() - 1);
+    if(!response || response->seq != seq || response->type != (type | Remote::RESPONSE) || !response->len) {
+        return {};
+    }
+    return std::vector<uint8_t>(response->payload, response->payload + response->len);
+}
+
+static std::optional<std::vector<uint8_t>> Request(Command command, std::initializer_list<uint8_t> args)
+{
+    std::vector<uint8_t> payload(args);
+    uint8_t frame[Utils::MaxFrameSize(16)];
+    auto len = Utils::EncodeFrame(frame, sizeof(frame), command, ++seq, payload.data(), payload.size());
+    return Feed(frame, len, command);
+}
+
+static void Expect(const char* what, Command command, std::initializer_list<uint8_t> args, Result expected)
+{
+    auto response = Request(command, args);
+    if(!response || (*response)[0] != expected) {
+        std::fprintf(stderr,
+                     "remote: %s: expected result %u, got %s %u\n",
+                     what,
+                     unsigned(expected),
+                     response ? "result" : "no response",
+                     response ? unsigned((*response)[0]) : 0U);
+        ++failures;
+    }
+}
+
+static void ExpectSetpoint(const char* what, Config::value_t celsius)
+{
+    auto stored = Sim::board.config[Config::SETPOINT_1];
+    if(stored != celsius) {
+        std::fprintf(stderr, "remote: %s: setpoint %d, expected %d\n", what, stored.value_or(-1), celsius);
+        ++failures;
+    }
+}
+
+static void Wait(uint32_t ms)
+{
+    Sim::systemTime += TIME_MS2I(ms);
+}
+
+static void CheckReads()
+{
+    auto ping = Request(Remote::CMD_PING, {});
+    if(!ping || ping->size() != 2 || (*ping)[1] != Remote::PROTOCOL_VERSION) {
+        std::fprintf(stderr, "remote: ping got no version\n");
+        ++failures;
+    }
+    auto status = Request(Remote::CMD_GET_STATUS, {0});
+    if(!status || status->size() != 1 + 3 * sizeof(float) + 1) {
+        std::fprintf(stderr, "remote: status of the wrong size\n");
+        ++failures;
+    }
+    Expect("status of a missing iron",
+           Remote::CMD_GET_STATUS,
+           {Drivers::Heater::CHANNELS_NUM},
+           Remote::RESULT_BAD_ARGUMENT);
+    Expect("subscribe while locked", Remote::CMD_SUBSCRIBE, {0, 0}, Remote::RESULT_OK);
+    Expect("unknown command", Command(0x3F), {}, Remote::RESULT_UNKNOWN_COMMAND);
+}
+
+static void CheckUnlock()
+{
+    constexpr uint8_t PIN_LO = REMOTE_PIN & 0xFF, PIN_HI = REMOTE_PIN >> 8;
+    constexpr uint8_t WRONG_LO = uint8_t(PIN_LO + 1);
+    Sim::board.config[Config::SETPOINT_1] = 250;
+    Expect("setpoint while locked", Remote::CMD_SET_SETPOINT, {0, 44, 1}, Remote::RESULT_LOCKED);
+    Expect("preset while locked", Remote::CMD_SELECT_PRESET, {0, 1}, Remote::RESULT_LOCKED);
+    ExpectSetpoint("locked", 250);
+    for(uint32_t i{}; i < Remote::UNLOCK_ATTEMPTS; ++i) {
+        Expect("wrong PIN", Remote::CMD_UNLOCK, {WRONG_LO, PIN_HI}, Remote::RESULT_BAD_ARGUMENT);
+    }
+    Expect("PIN during the lockout", Remote::CMD_UNLOCK, {PIN_LO, PIN_HI}, Remote::RESULT_LOCKED);
+    Wait(Remote::UNLOCK_LOCKOUT_MS);
+    Expect("PIN after the lockout", Remote::CMD_UNLOCK, {PIN_LO, PIN_HI}, Remote::RESULT_OK);
+    Expect("setpoint", Remote::CMD_SET_SETPOINT, {0, 44, 1}, Remote::RESULT_OK);
+    ExpectSetpoint("unlocked", 300);
+    Expect("preset", Remote::CMD_SELECT_PRESET, {0, 1}, Remote::RESULT_OK);
+    ExpectSetpoint("preset", 320);
+    Wait(Remote::UNLOCK_IDLE_MS);
+    Expect("setpoint after the idle time", Remote::CMD_SET_SETPOINT, {0, 44, 1}, Remote::RESULT_LOCKED);
+    ExpectSetpoint("lapsed", 320);
+}
+
+static void CheckBroken()
+{
+    uint8_t frame[Utils::MaxFrameSize(16)];
+    auto len = Utils::EncodeFrame(frame, sizeof(frame), Remote::CMD_PING, ++seq, nullptr, 0);
+    frame[1] ^= 0x10;
+    if(Feed(frame, len, Remote::CMD_PING)) {
+        std::fprintf(stderr, "remote: a broken frame got a response\n");
+        ++failures;
+    }
+    std::vector<uint8_t> oversized(512, 0x55);
+    oversized.push_back(0);
+    if(Feed(oversized.data(), oversized.size(), Remote::CMD_PING)) {
+        std::fprintf(stderr, "remote: an oversized frame got a response\n");
+        ++failures;
+    }
+    // The receive path starts over after both
+    Expect("ping after the broken frames", Remote::CMD_PING, {}, Remote::RESULT_OK);
+}
+
+int CheckRemote()
+{
+    CheckReads();
+    CheckUnlock();
+    CheckBroken();
+    auto stats = Remote::GetStats();
+    std::fprintf(stderr,
+                 "remote: %u requests, %u broken, %u refused, %zu failures\n",
+                 stats.requests,
+                 stats.errors,
+                 stats.refused,
+                 failures);
+    return !failures && stats.errors == 2 && stats.refused == 3 + Remote::UNLOCK_ATTEMPTS + 1 ? EXIT_SUCCESS
+                                                                                             : EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef S1D15710_MODEL_H
+#define S1D15710_MODEL_H
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+
+namespace Sim {
+
+/**
+ * @brief The part of the S1D15710 instruction set the driver uses: page and column addressing,
+ * the display data writes with the column auto-increment and the start line.
+ * The GRAM is dumped as a PBM image of the visible area. The segment and COM directions only
+ * match the panel mounting, so the image is left in the driver column order.
+ */
+class S1d15710Model
+{
+public:
+    static constexpr size_t COLUMNS = 256;
+    static constexpr size_t PAGES = 9;
+
+    void Command(uint8_t cmd)
+    {
+        if(expectElectronicControl_) {
+            expectElectronicControl_ = false;
+            return;
+        }
+        if((cmd & 0xF0) == 0x00) {
+            column_ = (column_ & 0xF0) | (cmd & 0x0F);
+        }
+        else if((cmd & 0xF0) == 0x10) {
+            column_ = uint8_t((cmd & 0x0F) << 4) | (column_ & 0x0F);
+        }
+        else if((cmd & 0xC0) == 0x40) {
+            startLine_ = cmd & 0x3F;
+        }
+        else if((cmd & 0xF0) == 0xB0) {
+            page_ = cmd & 0x0F;
+        }
+        else if((cmd & 0xFE) == 0xAE) {
+            on_ = cmd & 1;
+        }
+        else if(cmd == 0x81) {
+            expectElectronicControl_ = true;
+        }
+    }
+
+    void Data(uint8_t byte)
+    {
+        if(page_ < PAGES) {
+            gram_[page_][column_] = byte;
+        }
+        column_ = uint8_t(column_ + 1);
+    }
+
+    uint8_t Gram(size_t page, size_t column) const
+    {
+        return gram_[page][column];
+    }
+
+    /**
+     * @brief Visible area starting at the given GRAM column
+     */
+    bool DumpPbm(const char* path, size_t firstColumn, size_t width, size_t height) const
+    {
+        auto* file = std::fopen(path, "wb");
+        if(!file) {
+            return false;
+        }
+        std::fprintf(file, "P1\n%zu %zu\n", width, height);
+        for(size_t y{}; y < height; ++y) {
+            auto line = (y + startLine_) % (PAGES * 8);
+            for(size_t x{}; x < width; ++x) {
+                auto pixel = on_ && (gram_[line / 8][(firstColumn + x) % COLUMNS] >> (line % 8) & 1);
+                std::fputs(pixel ? "1 " : "0 ", file);
+            }
+            std::fputc('\n', file);
+        }
+        return std::fclose(file) == 0;
+    }
+
+private:
+    std::array<std::array<uint8_t, COLUMNS>, PAGES> gram_{};
+    uint8_t page_{};
+    uint8_t column_{};
+    uint8_t startLine_{};
+    bool on_{};
+    bool expectElectronicControl_{};
+};
+
+} // Sim
+
+#endif // S1D15710_MODEL_H
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "sensor_processing.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+/**
+ * The block processing of the sampling on a synthetic source standing for the circular DMA buffer: a half is
+ * filled scan by scan and handed over in place, as the ADC callback does, while the next one is written.
+ * The thermocouples get the heater switching spikes. Reports the processing time of a block with the control
+ * step and checks the averages and the reference it makes against the source values.
+ */
+
+using namespace Sensors;
+
+// Near the factory values of the F401
+constexpr Calibration CALIBRATION{.vrefint = 1500, .ts30 = 940, .ts110 = 1180};
+constexpr float VDDA = 3.25f;
+constexpr float BOARD_TEMPERATURE = 35.0f;
+constexpr int NOISE = 4;
+constexpr int SPIKE = 1500;
+
+static sample_t samples[2 * BLOCK_SCANS * CHANNELS_NUM];
+
+// What the reference has to come to: the counts scaled to VDDA = 3.3 V
+constexpr float ADC_GAIN = VDDA / 3.3f;
+
+// The source values of the channels in the scan order
+static std::array<float, CHANNELS_NUM> SourceValues()
+{
+    auto tsSlope = float(CALIBRATION.ts110 - CALIBRATION.ts30) / (110.0f - 30.0f);
+    auto tsCounts = (CALIBRATION.ts30 + (BOARD_TEMPERATURE - 30.0f) * tsSlope) / ADC_GAIN;
+    return {800, 1200, 400, 2708, 2708, 2650, 1000, 2000, 3000, tsCounts, CALIBRATION.vrefint / ADC_GAIN};
+}
+
+int CheckSampling()
+{
+    constexpr size_t BLOCKS = 200'000;
+    // The IIR of the supply channels settles in a few blocks, the reference in a few seconds
+    constexpr size_t SETTLE_BLOCKS = 500;
+    constexpr float BLOCKS_PER_SECOND = 50.0f;
+    SetCalibration(CALIBRATION);
+    auto source = SourceValues();
+    std::mt19937 rng{1};
+    std::uniform_int_distribution<int> noise{-NOISE, NOISE};
+    std::array<size_t, 3> sinceSpike{};
+    std::chrono::nanoseconds total{}, longest{};
+    float worstError{};
+    for(size_t block{}; block < BLOCKS; ++block) {
+        auto* half = &samples[(block % 2) * BLOCK_SCANS * CHANNELS_NUM];
+        for(size_t scan{}; scan < BLOCK_SCANS; ++scan) {
+            for(size_t ch{}; ch < CHANNELS_NUM; ++ch) {
+                auto value = int(source[ch] + 0.5f) + noise(rng);
+                // Isolated ones, what the median of three is there for
+                if(ch <= TC3 && ++sinceSpike[ch] > 2 && rng() % 16 == 0) {
+                    value += SPIKE;
+                    sinceSpike[ch] = 0;
+                }
+                half[scan * CHANNELS_NUM + ch] = sample_t(std::clamp<int>(value, 0, ADC_MAX));
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        ProcessBlock(*reinterpret_cast<const SampleBlock*>(half));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        total += elapsed;
+        longest = std::max<std::chrono::nanoseconds>(longest, elapsed);
+        if(block >= SETTLE_BLOCKS) {
+            for(size_t ch{}; ch < CHANNELS_NUM; ++ch) {
+                worstError = std::max(worstError, std::abs(float(GetAverage(Channel(ch))) - source[ch]));
+            }
+        }
+    }
+    auto reference = GetReference();
+    auto gainError = std::abs(reference.adcGain / ADC_GAIN - 1);
+    auto temperatureError = std::abs(reference.boardTemperature - BOARD_TEMPERATURE);
+    auto blockUs = double(total.count()) / 1000 / BLOCKS;
+    std::fprintf(stderr,
+                 "sampling: %zu blocks, %.2f us a block (max %.2f us), %.0f blocks/s, %.0f times the ADC rate, "
+                 "worst average error %.1f counts, gain error %.3f %%, board temperature %.2f C\n",
+                 BLOCKS,
+                 blockUs,
+                 double(longest.count()) / 1000,
+                 1e6 / blockUs,
+                 1e6 / blockUs / double(BLOCKS_PER_SECOND),
+                 double(worstError),
+                 double(gainError * 100),
+                 double(reference.boardTemperature));
+    bool averagesOk = worstError <= NOISE + 1;
+    bool referenceOk = gainError < 0.002f && temperatureError < 0.5f;
+    return averagesOk && referenceOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,677 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "display_bus.h"
+#include "filters.h"
+#include "hal.h"
+#include "heater.h"
+#include "heater_timer_model.h"
+#include "overheat.h"
+#include "page_buffer.h"
+#include "s1d15710_model.h"
+#include "sensor_handler.h"
+#include "simd.h"
+#include "stubs.h"
+#include "telemetry.h"
+#include "temp_control.h"
+#include "thermal_model.h"
+#include "thermocouple.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/**
+ * Closed loop of the three irons on the host: the firmware control step (temp_control.cpp) against
+ * the thermal model, the sensor counts are made from the model and the on-times go back to it.
+ * Prints a CSV of the control steps, a summary with the step timing to stderr and optionally
+ * the last frame of a bar graph drawn into a page buffer and sent by the S1D157xx driver to the controller model.
+ *
+ * Usage: jbc_sim [--seconds 30] [--kp 0.03] [--ki 0.02] [--kd 0.004] [--frame out.pbm]
+ *        the gains replace the cartridge defaults of all the irons when given
+ *        jbc_sim --tables    the thermocouple tables error against their polynomials and the lookup timing
+ *        jbc_sim --filters [trace]    the sensor filter chains on a recorded trace, one ADC count per line,
+ *                                     or on a synthetic one with the heater switching spikes and a step
+ *        jbc_sim --simd    the packed sample kernels with the emulated lanes against the plain loops, bit exact
+ *        jbc_sim --cutoff    the analog watchdog path on a stalled control, iron 1 is left on at full power
+ *        jbc_sim --display    the display driver bus traffic on the main screen updates, the GRAM against the frame
+ *        jbc_sim --eeprom    the config log on the M24C64 driver against the EEPROM model, wear and failures
+ *        jbc_sim --ina3221    the power monitor driver against the INA3221 model on the fake bus
+ *        jbc_sim --keys [trace]    the key scanner on a recorded bounce trace, "<microseconds> <raw bits in hex>"
+ *                                  per line for the bits from then on, or on a synthetic one
+ *        jbc_sim --log [capture]    the deferred log order and thread limit, and its cost per record
+ *        jbc_sim --render    the main screen through the mono draw callbacks against a call per pixel, bit exact,
+ *                            and the host cycles a frame
+ *        jbc_sim --sampling    the sample block processing on a synthetic ADC source, its throughput and averages
+ *        jbc_sim --pid    the PID engine in float and Q16 on the T245/C210 models, overshoot, settle time and cost
+ *        jbc_sim --power    the supply current of the heaters with the power scheduler and without it
+ *        jbc_sim --profiler    the profiler report on threads declared to the host registry
+ *        jbc_sim --timeline    the heater driver on the timer model, no heater on while the thermocouples settle
+ *                              and are converted
+ *        jbc_sim --remote    the remote protocol on a loopback port, the PIN gate of the setpoint commands
+ */
+
+using namespace Drivers;
+
+constexpr float DT = float(Heater::PERIOD * Sensors::BLOCK_SCANS) / Heater::TICK_FREQUENCY;
+constexpr float PERIOD_SECONDS = float(Heater::PERIOD) / Heater::TICK_FREQUENCY;
+constexpr uint32_t MAX_TICKS =
+  Heater::PERIOD - Heater::DEFAULT_SETTLE_TICKS - Heater::TC_CONVERSION_TICKS - Heater::MIN_START;
+constexpr float AMBIENT = Sim::T245_MODEL.ambient;
+constexpr float SETPOINT = 350.0f;
+constexpr float SETTLE_BAND = 2.0f;
+
+constexpr float VIN = 24.0f;
+// The divider and the full scale the control assumes, see temp_control.cpp
+constexpr float VIN_VOLTS_PER_COUNT = 3.3f * 11 / 4096;
+
+struct Iron
+{
+    Control::Cartridge cartridge;
+    float ratedPower;
+    Sim::IronModel::Params model;
+    bool inUse;
+};
+
+// T245 and C210 cartridges, iron 1 is out of the stand
+constexpr Iron IRONS[Heater::CHANNELS_NUM] = {
+  {Control::Cartridge::T245, Control::T245_DEFAULTS.maxPower, Sim::T245_MODEL, true},
+  {Control::Cartridge::T245, Control::T245_DEFAULTS.maxPower, Sim::T245_MODEL, false},
+  {Control::Cartridge::C210, Control::C210_DEFAULTS.maxPower, Sim::C210_MODEL, false},
+};
+
+// A solder joint on iron 1
+constexpr float LOAD_START = 10.0f;
+constexpr float LOAD_END = 12.0f;
+constexpr float LOAD_WATTS = 40.0f;
+
+struct Result
+{
+    float maxTemperature;
+    float settledAt;
+};
+
+struct Area
+{
+    MonoDraw::coord_t x1, y1, x2, y2;
+};
+
+// A bar per iron, drawn with the firmware page buffer primitives and sent through the display driver
+static void DrawBars(const float* temperatures)
+{
+    using Props = Sim::Display::Props;
+    constexpr MonoDraw::coord_t BAR_HEIGHT = 12;
+    static std::array<uint8_t, Props::X_DIM * Props::PAGES> buffer;
+    buffer.fill(0);
+    MonoDraw::PageBuf pb{buffer.data(), 0, 0, Props::X_DIM};
+    for(size_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        auto length = MonoDraw::coord_t(std::clamp(temperatures[ch] / 450.0f, 0.0f, 1.0f) * float(Props::X_DIM));
+        // Off the page boundaries, to go through the partial page masks
+        auto top = MonoDraw::coord_t(3 + ch * 20);
+        MonoDraw::fill(pb, Area{0, top, MonoDraw::coord_t(Props::X_DIM - 1), MonoDraw::coord_t(top)}, true);
+        if(length) {
+            MonoDraw::fill(pb, Area{0, top, MonoDraw::coord_t(length - 1), MonoDraw::coord_t(top + BAR_HEIGHT)}, true);
+        }
+    }
+    for(size_t page{}; page < Props::PAGES; ++page) {
+        Sim::Display::PutPage(0, Props::X_DIM, page, &buffer[page * Props::X_DIM]);
+    }
+}
+
+template<const auto& emf>
+static void CheckTable(const char* name, const Thermocouple::Table& table)
+{
+    constexpr size_t ROUNDS = 1000;
+    double maxError{};
+    for(uint32_t counts{}; counts <= Thermocouple::Table::MAX_INPUT; ++counts) {
+        auto reference = emf(counts * Thermocouple::MICROVOLTS_PER_COUNT);
+        maxError = std::max(maxError, std::abs(double(float(table(counts))) - reference));
+    }
+    // The float polynomial is what the table replaces on the target
+    [[maybe_unused]] volatile float sink{};
+    auto start = std::chrono::steady_clock::now();
+    for(size_t round{}; round < ROUNDS; ++round) {
+        for(uint32_t counts{}; counts <= Thermocouple::Table::MAX_INPUT; ++counts) {
+            sink = float(table(counts));
+        }
+    }
+    auto tableTime = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for(size_t round{}; round < ROUNDS; ++round) {
+        for(uint32_t counts{}; counts <= Thermocouple::Table::MAX_INPUT; ++counts) {
+            auto uv = float(counts) * float(Thermocouple::MICROVOLTS_PER_COUNT);
+            float result{};
+            for(size_t i = emf.coeffs.size(); i-- > 0;) {
+                result = result * uv + float(emf.coeffs[i]);
+            }
+            sink = result;
+        }
+    }
+    auto polyTime = std::chrono::steady_clock::now() - start;
+    constexpr double LOOKUPS = ROUNDS * (Thermocouple::Table::MAX_INPUT + 1);
+    std::fprintf(stderr,
+                 "%s: max error %.4f C, table %.2f ns, polynomial %.2f ns\n",
+                 name,
+                 maxError,
+                 std::chrono::duration<double, std::nano>(tableTime).count() / LOOKUPS,
+                 std::chrono::duration<double, std::nano>(polyTime).count() / LOOKUPS);
+}
+
+struct HostClock
+{
+    static uint32_t Now()
+    {
+        return uint32_t(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+};
+
+constexpr size_t TRACE_STEP_AT = 4000;
+
+static std::vector<int32_t> SyntheticTrace()
+{
+    constexpr int32_t LEVEL = 2000;
+    constexpr int32_t STEP = 200;
+    constexpr int32_t SPIKE = 300;
+    std::mt19937 rng{1};
+    std::normal_distribution<float> noise{0.0f, 3.0f};
+    std::bernoulli_distribution spike{0.2};
+    std::vector<int32_t> trace(2 * TRACE_STEP_AT);
+    bool spiked{};
+    for(size_t i{}; i < trace.size(); ++i) {
+        // A switching spike hits a single conversion
+        spiked = !spiked && spike(rng);
+        trace[i] = LEVEL + (i >= TRACE_STEP_AT ? STEP : 0) + int32_t(noise(rng)) + (spiked ? SPIKE : 0);
+    }
+    return trace;
+}
+
+// Noise and spike residue before the step against the median of that part, the step delay to the half of it
+template<typename Chain>
+static void CheckFilter(const char* name, const std::vector<int32_t>& trace, size_t stepAt)
+{
+    Chain chain;
+    // The first pass warms the caches up
+    for(auto sample : trace) {
+        int32_t out;
+        chain.Process(sample, out);
+    }
+    chain = Chain{};
+    std::vector<std::pair<size_t, int32_t>> outputs;
+    outputs.reserve(trace.size());
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i{}; i < trace.size(); ++i) {
+        int32_t out;
+        if(chain.Process(trace[i], out)) {
+            outputs.emplace_back(i, out);
+        }
+    }
+    auto perSample = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start) / trace.size();
+    std::vector<int32_t> before;
+    for(auto [i, out] : outputs) {
+        if(i >= stepAt / 2 && i < stepAt) {
+            before.push_back(out);
+        }
+    }
+    if(before.empty()) {
+        return;
+    }
+    auto sorted = before;
+    std::ranges::sort(sorted);
+    auto level = sorted[sorted.size() / 2];
+    double sumSquares{};
+    int32_t worst{};
+    for(auto out : before) {
+        sumSquares += double(out - level) * (out - level);
+        worst = std::max(worst, std::abs(out - level));
+    }
+    double after{};
+    size_t afterCount{};
+    for(auto [i, out] : outputs) {
+        if(i >= stepAt + stepAt / 2) {
+            after += out;
+            ++afterCount;
+        }
+    }
+    auto half = (level + (afterCount ? after / afterCount : level)) / 2;
+    size_t delay{};
+    for(auto [i, out] : outputs) {
+        if(i >= stepAt && out >= half) {
+            delay = i - stepAt;
+            break;
+        }
+    }
+    std::fprintf(stderr,
+                 "%-24s noise %.2f, worst %d counts, step delay %.1f ms, %.1f ns/sample, stages",
+                 name,
+                 std::sqrt(sumSquares / before.size()),
+                 worst,
+                 double(delay) * PERIOD_SECONDS * 1000,
+                 perSample.count());
+    for(auto ns : chain.CyclesMax()) {
+        std::fprintf(stderr, " %u", ns);
+    }
+    // The host scheduler shows up in these, the target runs them with the interrupts only
+    std::fprintf(stderr, " ns max\n");
+}
+
+static int CheckFilters(const char* path)
+{
+    std::vector<int32_t> trace;
+    size_t stepAt = TRACE_STEP_AT;
+    if(path) {
+        auto* file = std::fopen(path, "r");
+        if(!file) {
+            std::fprintf(stderr, "Can't read %s\n", path);
+            return EXIT_FAILURE;
+        }
+        int value;
+        while(std::fscanf(file, "%d", &value) == 1) {
+            trace.push_back(value);
+        }
+        std::fclose(file);
+        // A recorded trace has no known step, the second half is taken as one
+        stepAt = trace.size() / 2;
+    }
+    else {
+        trace = SyntheticTrace();
+    }
+    using namespace Math;
+    constexpr size_t N = Sensors::BLOCK_SCANS;
+    CheckFilter<FilterChain<HostClock, Decimator<N>>>("average", trace, stepAt);
+    CheckFilter<FilterChain<HostClock, RunningMedian<3>, Decimator<N>>>("median 3, average", trace, stepAt);
+    CheckFilter<FilterChain<HostClock, RunningMedian<5>, Decimator<N>>>("median 5, average", trace, stepAt);
+    CheckFilter<FilterChain<HostClock, RunningMedian<3>, Decimator<N>, SinglePoleIir<2>>>(
+      "median 3, average, iir 2", trace, stepAt);
+    return EXIT_SUCCESS;
+}
+
+// One column range of the packed kernels against the plain loops, false on the first difference
+template<size_t FIRST, size_t COLS, size_t STRIDE, size_t ROWS>
+static bool CheckKernels(const Simd::Rows<STRIDE, ROWS>& rows, const std::array<int16_t, COLS>& weights)
+{
+    using Lanes = Simd::EmulatedLanes;
+    std::array<uint16_t, COLS> packedSums, sums, packedMins, mins, packedMaxs, maxs;
+    Simd::Packed::SumColumns<Lanes, FIRST>(rows, packedSums);
+    Simd::Scalar::SumColumns<FIRST>(rows, sums);
+    Simd::Packed::MinMaxColumns<Lanes, FIRST>(rows, packedMins, packedMaxs);
+    Simd::Scalar::MinMaxColumns<FIRST>(rows, mins, maxs);
+    bool same = packedSums == sums && packedMins == mins && packedMaxs == maxs;
+    for(const auto& row : rows) {
+        same = same && Simd::Packed::Dot<Lanes, FIRST>(row, weights) == Simd::Scalar::Dot<FIRST>(row, weights);
+    }
+    return same;
+}
+
+static int CheckSimd()
+{
+    constexpr size_t STRIDE = Sensors::CHANNELS_NUM;
+    constexpr size_t RUNS = 100'000;
+    std::mt19937 rng{1};
+    // The full range and the extremes, to cover the wrapping and the signed lanes along with the ADC counts
+    auto sample = [&rng] {
+        switch(rng() % 4) {
+            case 0: return uint16_t(rng() & 0xFFF);
+            case 1: return uint16_t(rng());
+            case 2: return uint16_t(0);
+            default: return uint16_t(0xFFFF);
+        }
+    };
+    auto fill = [&](auto& rows, auto& weights) {
+        for(auto& row : rows) {
+            std::generate(row.begin(), row.end(), sample);
+        }
+        std::generate(weights.begin(), weights.end(), [&] { return int16_t(sample()); });
+    };
+    size_t failures{};
+    Simd::Rows<STRIDE, Sensors::BLOCK_SCANS> block;
+    Simd::Rows<STRIDE, 1> single;
+    std::array<int16_t, STRIDE> weights;
+    std::array<int16_t, 5> plainWeights;
+    std::array<int16_t, 4> oddWeights;
+    for(size_t run{}; run < RUNS; ++run) {
+        fill(block, weights);
+        fill(single, plainWeights);
+        std::generate(oddWeights.begin(), oddWeights.end(), [&] { return int16_t(sample()); });
+        // Whole scan with the odd tail, the sensor handler range, a pair range off the word boundary
+        bool same = CheckKernels<0>(block, weights) && CheckKernels<Sensors::HNDL_SEN1>(block, plainWeights) &&
+                    CheckKernels<1>(block, oddWeights) && CheckKernels<Sensors::HNDL_SEN1>(single, plainWeights);
+        failures += !same;
+    }
+    std::fprintf(stderr,
+                 "simd: %zu random blocks, %zu mismatches, this build dispatches to the %s\n",
+                 RUNS,
+                 failures,
+                 Simd::NATIVE ? "DSP instructions" : "plain loops");
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// The watchdog timing of the target, 84 MHz core and the ADC at PCLK2 / 4
+constexpr Overheat::Timing CUTOFF_TIMING{
+  .cpuHz = 84'000'000,
+  .adcHz = 21'000'000,
+  .tickHz = Heater::TICK_FREQUENCY,
+  .periodTicks = Heater::PERIOD,
+  .triggerTicks = Heater::SAMPLING_TICKS,
+  .conversionClocks = 480 + 12,
+};
+
+// The latency is taken back from the period stamp, whatever the counter wrap and a period interrupt in between
+static bool CheckLatencyArithmetic()
+{
+    constexpr uint32_t PERIOD_CYCLES = Heater::PERIOD * (CUTOFF_TIMING.cpuHz / CUTOFF_TIMING.tickHz);
+    for(uint32_t stamp : {0U, 123'456U, 0xFFFF'FFFFU - PERIOD_CYCLES / 2}) {
+        for(size_t position{}; position < Heater::CHANNELS_NUM; ++position) {
+            auto fault = stamp + Overheat::FaultOffsetCycles(CUTOFF_TIMING, position);
+            for(uint32_t delay : {12U, 1000U, 10'000U}) {
+                auto now = fault + delay;
+                // The period interrupt comes before the handler when the delay crosses the period end
+                auto seen = int32_t(now - stamp - PERIOD_CYCLES) >= 0 ? stamp + PERIOD_CYCLES : stamp;
+                if(Overheat::LatencyCycles(CUTOFF_TIMING, now, seen, position) != delay) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// A cold iron 1 at full demand, then the latch: the control must stop heating and say so
+static bool CheckCutoffReported()
+{
+    Heater::Init();
+    Sim::HeaterTimerModel timer;
+    Control::init();
+    Control::SetCartridge(Heater::IRON_1, IRONS[0].cartridge);
+    Control::SetSetpoint(Heater::IRON_1, SETPOINT);
+    palSetLine(LINE_SLEEP_SEN1);
+    Sensors::Scan averages{};
+    for(size_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        averages[Sensors::VIN1 + ch] = Sensors::sample_t(VIN / VIN_VOLTS_PER_COUNT);
+    }
+    const Sensors::Reference reference{.adcGain = 1.0f, .boardTemperature = AMBIENT};
+    Control::Update(averages, reference);
+    auto before = Control::GetStatus(Heater::IRON_1);
+    bool heated = timer.Run().onTicks[Heater::IRON_1] > 0;
+    auto refreshes = Sim::board.refreshes;
+    Heater::CutOffX();
+    Control::Update(averages, reference);
+    auto after = Control::GetStatus(Heater::IRON_1);
+    auto sample = Telemetry::Collect();
+    bool stopped = after.cutOff && after.duty == 0 && !Heater::IsHeatingI(Heater::IRON_1) &&
+                   !timer.Run().onTicks[Heater::IRON_1];
+    // The edge wakes the display, the next step doesn't
+    bool refreshed = Sim::board.refreshes == refreshes + 1;
+    Control::Update(averages, reference);
+    refreshed = refreshed && Sim::board.refreshes == refreshes + 1;
+    bool reported = before.duty > 0 && !before.cutOff && heated && stopped && refreshed && sample.cutOff &&
+                    sample.irons[Heater::IRON_1].duty == 0;
+    return reported;
+}
+
+static int CheckCutoff()
+{
+    constexpr float SECONDS = 20.0f;
+    // Iron 1 has its on-time stuck at the maximum, iron 2 has no cartridge and reads the full scale,
+    // iron 3 idles in the stand
+    constexpr uint32_t HEATING_MASK = 1U << Heater::IRON_1;
+    constexpr Sensors::sample_t OPEN_COUNTS = Sensors::ADC_MAX;
+    Sim::IronModel models[Heater::CHANNELS_NUM]{
+      Sim::IronModel{IRONS[0].model}, Sim::IronModel{IRONS[1].model}, Sim::IronModel{IRONS[2].model}};
+    const Thermocouple::Table* tables[Heater::CHANNELS_NUM] = {
+      &Thermocouple::T245, &Thermocouple::T245, &Thermocouple::C210};
+    // As the control sets them, with the cold junction at the ambient and the unity ADC gain
+    uint32_t limits[Heater::CHANNELS_NUM];
+    for(size_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        limits[ch] = Thermocouple::CountsFor(*tables[ch], Overheat::CUTOFF_CELSIUS - AMBIENT);
+    }
+    size_t watched = Heater::CHANNELS_NUM;
+    size_t trippedOn = Heater::CHANNELS_NUM;
+    float trippedAt{}, sensorAtTrip{}, peak{};
+    auto periods = size_t(SECONDS / PERIOD_SECONDS);
+    for(size_t period{}; period < periods; ++period) {
+        bool cutOff = trippedOn != Heater::CHANNELS_NUM;
+        for(size_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+            auto heating = !cutOff && (HEATING_MASK & (1U << ch));
+            auto watts = heating ? IRONS[ch].ratedPower * float(MAX_TICKS) / Heater::PERIOD : 0.0f;
+            models[ch].Step(watts, 0, PERIOD_SECONDS);
+        }
+        peak = std::max(peak, models[Heater::IRON_1].Temperature());
+        // The scan at the period end, the watchdog compares the watched channel only
+        if(!cutOff && watched < Heater::CHANNELS_NUM) {
+            auto counts = watched == Heater::IRON_2
+                            ? OPEN_COUNTS
+                            : Thermocouple::CountsFor(*tables[watched], models[watched].SensorTemperature() - AMBIENT);
+            if(counts > limits[watched]) {
+                trippedOn = watched;
+                trippedAt = float(period + 1) * PERIOD_SECONDS;
+                sensorAtTrip = models[watched].SensorTemperature();
+            }
+        }
+        // Block end, the DMA callback moves the watchdog on
+        if((period + 1) % Sensors::BLOCK_SCANS == 0) {
+            watched = trippedOn == Heater::CHANNELS_NUM ? Overheat::NextWatched(watched, HEATING_MASK) : watched;
+        }
+    }
+    bool arithmetic = CheckLatencyArithmetic();
+    bool reported = CheckCutoffReported();
+    if(trippedOn == Heater::CHANNELS_NUM) {
+        std::fprintf(stderr, "cutoff: no trip in %.0f s, tip at %.1f C\n", double(SECONDS), double(peak));
+        return EXIT_FAILURE;
+    }
+    std::fprintf(stderr,
+                 "cutoff: iron %zu tripped at %.2f s, sensor %.1f C, tip peak %.1f C, limit %.0f C, "
+                 "latency arithmetic %s, control %s\n",
+                 trippedOn + 1,
+                 double(trippedAt),
+                 double(sensorAtTrip),
+                 double(peak),
+                 double(Overheat::CUTOFF_CELSIUS),
+                 arithmetic ? "ok" : "wrong",
+                 reported ? "stopped" : "still heating");
+    return trippedOn == Heater::IRON_1 && arithmetic && reported ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc == 2 && !std::strcmp(argv[1], "--display")) {
+        return CheckDisplay();
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--eeprom")) {
+        return CheckEeprom();
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--ina3221")) {
+        return CheckIna3221();
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--render")) {
+        return CheckRender();
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--sampling")) {
+        return CheckSampling();
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--pid")) {
+        return CheckPid();
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--power")) {
+        return CheckPower();
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--profiler")) {
+        return CheckProfiler();
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--timeline")) {
+        return CheckTimeline();
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--remote")) {
+        return CheckRemote();
+    }
+    if(argc >= 2 && !std::strcmp(argv[1], "--keys")) {
+        return CheckKeys(argc > 2 ? argv[2] : nullptr);
+    }
+    if(argc >= 2 && !std::strcmp(argv[1], "--log")) {
+        return CheckLog(argc > 2 ? argv[2] : nullptr);
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--cutoff")) {
+        return CheckCutoff();
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--simd")) {
+        return CheckSimd();
+    }
+    if(argc >= 2 && !std::strcmp(argv[1], "--filters")) {
+        return CheckFilters(argc > 2 ? argv[2] : nullptr);
+    }
+    if(argc == 2 && !std::strcmp(argv[1], "--tables")) {
+        CheckTable<Thermocouple::T245_EMF>("T245", Thermocouple::T245);
+        CheckTable<Thermocouple::C210_EMF>("C210", Thermocouple::C210);
+        return EXIT_SUCCESS;
+    }
+    float seconds = 30.0f;
+    Control::TipProfile gains{
+      .cartridge = {}, .tempOffset = 0, .kp = 0.03f, .ki = 0.02f, .kd = 0.004f, .maxPower = 0};
+    bool customGains{};
+    const char* framePath{};
+    for(int i = 1; i + 1 < argc; i += 2) {
+        if(!std::strcmp(argv[i], "--seconds")) {
+            seconds = std::strtof(argv[i + 1], nullptr);
+        }
+        else if(!std::strcmp(argv[i], "--kp")) {
+            gains.kp = std::strtof(argv[i + 1], nullptr);
+            customGains = true;
+        }
+        else if(!std::strcmp(argv[i], "--ki")) {
+            gains.ki = std::strtof(argv[i + 1], nullptr);
+            customGains = true;
+        }
+        else if(!std::strcmp(argv[i], "--kd")) {
+            gains.kd = std::strtof(argv[i + 1], nullptr);
+            customGains = true;
+        }
+        else if(!std::strcmp(argv[i], "--frame")) {
+            framePath = argv[i + 1];
+        }
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    Heater::Init();
+    Sim::HeaterTimerModel timer;
+    Control::init();
+    for(size_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        auto channel = Heater::Channel(ch);
+        Control::SetCartridge(channel, IRONS[ch].cartridge);
+        if(customGains) {
+            gains.cartridge = IRONS[ch].cartridge;
+            gains.maxPower = IRONS[ch].ratedPower;
+            Control::SetTip(channel, gains, 0);
+        }
+        Control::SetSetpoint(channel, SETPOINT);
+        // The stand contacts pull the line low
+        constexpr ioline_t standLines[Heater::CHANNELS_NUM] = {LINE_SLEEP_SEN1, LINE_SLEEP_SEN2, LINE_SLEEP_SEN3};
+        if(IRONS[ch].inUse) {
+            palSetLine(standLines[ch]);
+        }
+    }
+    Sim::IronModel models[Heater::CHANNELS_NUM]{
+      Sim::IronModel{IRONS[0].model}, Sim::IronModel{IRONS[1].model}, Sim::IronModel{IRONS[2].model}};
+    const Thermocouple::Table* tables[Heater::CHANNELS_NUM] = {
+      &Thermocouple::T245, &Thermocouple::T245, &Thermocouple::C210};
+    // The unity ADC gain, the cold junction at the ambient
+    const Sensors::Reference reference{.adcGain = 1.0f, .boardTemperature = AMBIENT};
+    Result results[Heater::CHANNELS_NUM]{};
+    float temperatures[Heater::CHANNELS_NUM]{};
+    uint64_t stepNs{}, stepMaxNs{};
+    auto steps = size_t(seconds / DT);
+
+    std::printf("time,temperature1,duty1,temperature2,duty2,temperature3,duty3\n");
+    for(size_t step{}; step < steps; ++step) {
+        auto time = float(step) * DT;
+        Sensors::Scan averages{};
+        for(size_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+            averages[Sensors::TC1 + ch] = Sensors::sample_t(
+              Thermocouple::CountsFor(*tables[ch], models[ch].SensorTemperature() - reference.boardTemperature));
+            averages[Sensors::VIN1 + ch] = Sensors::sample_t(VIN / VIN_VOLTS_PER_COUNT);
+        }
+        auto start = std::chrono::steady_clock::now();
+        Control::Update(averages, reference);
+        uint64_t elapsed =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        stepNs += elapsed;
+        stepMaxNs = std::max(stepMaxNs, elapsed);
+        Sim::systemTime += TIME_MS2I(uint32_t(DT * 1000));
+
+        // The on-times take effect from the next heater period
+        std::array<float, Heater::CHANNELS_NUM> energy{};
+        for(size_t scan{}; scan < Sensors::BLOCK_SCANS; ++scan) {
+            auto period = timer.Run();
+            for(size_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+                auto load = ch == 0 && time >= LOAD_START && time < LOAD_END ? LOAD_WATTS : 0.0f;
+                auto watts = IRONS[ch].ratedPower * float(period.onTicks[ch]) / Heater::PERIOD;
+                models[ch].Step(watts, load, PERIOD_SECONDS);
+                energy[ch] += watts;
+            }
+        }
+
+        std::printf("%.2f", double(time));
+        for(size_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+            // An ideal power monitor, it reads the average power of the block
+            auto watts = energy[ch] / Sensors::BLOCK_SCANS;
+            Sim::board.readings[ch] = PowerMonitor::Reading{.volts = VIN, .amps = watts / VIN, .watts = watts};
+            auto& result = results[ch];
+            temperatures[ch] = models[ch].Temperature();
+            result.maxTemperature = std::max(result.maxTemperature, temperatures[ch]);
+            if(std::abs(temperatures[ch] - SETPOINT) > SETTLE_BAND && time < LOAD_START) {
+                result.settledAt = time + DT;
+            }
+            std::printf(",%.2f,%.3f", double(temperatures[ch]), double(Control::GetStatus(Heater::Channel(ch)).duty));
+        }
+        std::printf("\n");
+    }
+
+    for(size_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+        std::fprintf(stderr,
+                     "iron %zu: overshoot %.1f C, settled in %.2f s\n",
+                     ch + 1,
+                     double(results[ch].maxTemperature - SETPOINT),
+                     double(results[ch].settledAt));
+    }
+    std::fprintf(stderr,
+                 "control step: mean %llu ns, max %llu ns\n",
+                 (unsigned long long)(steps ? stepNs / steps : 0),
+                 (unsigned long long)stepMaxNs);
+
+    if(framePath) {
+        Sim::S1d15710Model display;
+        Sim::DisplayBus bus{display};
+        Sim::Display::Init();
+        DrawBars(temperatures);
+        using Props = Sim::Display::Props;
+        if(!display.DumpPbm(framePath, Props::X_OFFSET, Props::X_DIM, Props::Y_DIM)) {
+            std::fprintf(stderr, "Can't write %s\n", framePath);
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "stubs.h"
+#include "display_handler.h"
+#include "overheat.h"
+#include "sensor_handler.h"
+#include "telemetry.h"
+#include "temp_control.h"
+
+// Host versions of the modules temp_control.cpp, remote.cpp and profiler.cpp link against, backed by Sim::board
+
+namespace Config {
+
+value_t Get(Key key, value_t defaultValue)
+{
+    return Sim::board.config[key].value_or(defaultValue);
+}
+
+void Set(Key key, value_t value)
+{
+    SetI(key, value);
+}
+
+void SetI(Key key, value_t value)
+{
+    Sim::board.config[key] = value;
+    ++Sim::board.configWrites;
+}
+
+Stats GetStats()
+{
+    return {};
+}
+
+} // Config
+
+namespace PowerMonitor {
+
+std::optional<Reading> GetReading(Channel ch)
+{
+    return Sim::board.readings[ch];
+}
+
+Stats GetStats()
+{
+    return {};
+}
+
+} // PowerMonitor
+
+namespace Sensors {
+
+Stats GetStats()
+{
+    return {};
+}
+
+} // Sensors
+
+namespace Overheat {
+
+void SetLimit(Channel ch, Sensors::sample_t counts)
+{
+    Sim::board.overheatLimits[ch] = counts;
+}
+
+Stats GetStats()
+{
+    return {};
+}
+
+} // Overheat
+
+namespace Telemetry {
+
+Sample Collect()
+{
+    Sample sample{};
+    sample.timeMs = uint32_t(TIME_I2MS(chVTGetSystemTimeX()));
+    sample.cutOff = Drivers::Heater::IsCutOff();
+    for(uint32_t ch{}; ch < Drivers::Heater::CHANNELS_NUM; ++ch) {
+        auto status = Control::GetStatus(Drivers::Heater::Channel(ch));
+        auto reading = PowerMonitor::GetReading(Drivers::Heater::Channel(ch));
+        sample.irons[ch] = {
+          .temperature = status.temperature,
+          .setpoint = status.setpoint,
+          .duty = status.duty,
+          .volts = reading ? reading->volts : 0.0f,
+          .amps = reading ? reading->amps : 0.0f,
+        };
+    }
+    return sample;
+}
+
+void PublishScans(const Sensors::SampleBlock&, const Sensors::Reference&)
+{ }
+
+BaseSequentialStream* OpenConsole()
+{
+    return nullptr;
+}
+
+Stats GetStats()
+{
+    return {};
+}
+
+} // Telemetry
+
+namespace Ui {
+
+void RequestRefresh()
+{
+    ++Sim::board.refreshes;
+}
+
+FrameStats GetFrameStats()
+{
+    return {};
+}
+
+void RunBenchmark(uint32_t)
+{ }
+
+} // Ui
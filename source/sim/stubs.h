@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STUBS_H
+#define STUBS_H
+
+#include "config_store.h"
+#include "heater.h"
+#include "power_monitor.h"
+#include <array>
+#include <optional>
+
+namespace Sim {
+
+/**
+ * @brief What the firmware modules around the control step would hold on the target.
+ * The heater driver itself runs on the timer model, the simulation feeds the power readings and the stand lines.
+ */
+struct Board
+{
+    std::array<uint16_t, Drivers::Heater::CHANNELS_NUM> overheatLimits;
+    std::array<std::optional<PowerMonitor::Reading>, Drivers::Heater::CHANNELS_NUM> readings;
+    std::array<std::optional<Config::value_t>, Config::KEYS_NUM> config;
+    uint32_t configWrites;
+    uint32_t refreshes;
+};
+
+inline Board board;
+
+} // Sim
+
+#endif // STUBS_H
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef THERMAL_MODEL_H
+#define THERMAL_MODEL_H
+
+namespace Sim {
+
+/**
+ * @brief Lumped model of a cartridge: the heater and the tip share one heat capacity, the losses go
+ * to the ambient through a thermal resistance plus whatever the work piece takes. The thermocouple
+ * follows the tip with a first order lag.
+ */
+class IronModel
+{
+public:
+    struct Params
+    {
+        float heatCapacity;      // J/K
+        float thermalResistance; // K/W, to the ambient
+        float sensorTau;         // s
+        float ambient;
+    };
+
+    constexpr explicit IronModel(const Params& params) :
+      params_{params}, temperature_{params.ambient}, sensor_{params.ambient}
+    { }
+
+    constexpr void Step(float heaterWatts, float loadWatts, float dt)
+    {
+        auto losses = (temperature_ - params_.ambient) / params_.thermalResistance + loadWatts;
+        temperature_ += (heaterWatts - losses) * dt / params_.heatCapacity;
+        sensor_ += (temperature_ - sensor_) * dt / (params_.sensorTau + dt);
+    }
+
+    constexpr float Temperature() const
+    {
+        return temperature_;
+    }
+
+    constexpr float SensorTemperature() const
+    {
+        return sensor_;
+    }
+
+private:
+    Params params_;
+    float temperature_;
+    float sensor_;
+};
+
+// The cartridges of the closed loop checks, in a still air at 25 C
+constexpr IronModel::Params T245_MODEL{
+  .heatCapacity = 3.0f, .thermalResistance = 20.0f, .sensorTau = 0.1f, .ambient = 25.0f};
+constexpr IronModel::Params C210_MODEL{
+  .heatCapacity = 0.8f, .thermalResistance = 40.0f, .sensorTau = 0.05f, .ambient = 25.0f};
+
+} // Sim
+
+#endif // THERMAL_MODEL_H
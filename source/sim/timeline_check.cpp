@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "checks.h"
+#include "heater.h"
+#include "heater_timer_model.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+/**
+ * The heater driver on the TIM1 model, against the TIM4 trigger of the thermocouple scan: the heaters must be
+ * off for the settle time before the trigger and through the TC conversions after it. Random on-times are set
+ * at random points of the periods, the settle time and the interrupt latency change every few periods.
+ * A late interrupt may keep a short on-time on past its end, the conversions must stay clean while the latency
+ * is below the settle time, and the settle window too when the interrupts are served at once.
+ */
+
+using namespace Drivers;
+
+struct Request
+{
+    uint32_t start;
+    uint32_t ticks;
+};
+
+int CheckTimeline()
+{
+    constexpr size_t PERIODS = 50'000;
+    constexpr size_t PERIODS_PER_CASE = 50;
+    constexpr uint32_t MAX_SETTLE = 100;
+    Heater::Init();
+    Sim::HeaterTimerModel timer;
+    std::mt19937 rng{1};
+    uint32_t settle{}, latency{}, maxLatency{};
+    std::array<Request, Heater::CHANNELS_NUM> pending{}, active{};
+    size_t missedTriggers{}, conversionOverlaps{}, settleOverlaps{}, overruns{};
+    uint32_t worstIntrusion{};
+    for(size_t n{}; n < PERIODS; ++n) {
+        bool newCase = n % PERIODS_PER_CASE == 0;
+        if(newCase) {
+            settle = uint32_t(rng() % (MAX_SETTLE + 1));
+            latency = settle && rng() % 4 ? uint32_t(rng() % settle) : 0;
+            maxLatency = std::max(maxLatency, latency);
+            timer.SetLatency(latency);
+        }
+        // The control thread sets the on-times anywhere in the period
+        auto updateAt = uint32_t(rng() % Heater::PERIOD);
+        auto period = timer.Run([&](uint32_t cnt) {
+            if(!cnt && newCase) {
+                Heater::SetSettleTime(settle);
+            }
+            if(cnt == updateAt) {
+                for(uint32_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+                    pending[ch] = {uint32_t(rng() % Heater::PERIOD), uint32_t(rng() % (Heater::PERIOD + 50))};
+                    Heater::SetOnTime(Heater::Channel(ch), pending[ch].start, pending[ch].ticks);
+                }
+            }
+            // The period interrupt takes what is pending when it runs
+            if(cnt == latency) {
+                active = pending;
+            }
+        });
+        if(period.trigger != Heater::SAMPLING_TICKS) {
+            ++missedTriggers;
+            continue;
+        }
+        auto conversionsEnd = std::min(period.trigger + Heater::TC_CONVERSION_TICKS, Heater::PERIOD);
+        conversionOverlaps += std::any_of(&period.outputs[period.trigger], &period.outputs[conversionsEnd],
+                                          [](uint8_t outputs) { return outputs != 0; });
+        auto intrusion = uint32_t(std::count_if(&period.outputs[period.trigger - settle],
+                                                &period.outputs[period.trigger],
+                                                [](uint8_t outputs) { return outputs != 0; }));
+        settleOverlaps += !latency && intrusion;
+        worstIntrusion = std::max(worstIntrusion, intrusion);
+        // Nothing set during the period may take effect in it, nor stretch an on-time past the latency
+        for(uint32_t ch{}; ch < Heater::CHANNELS_NUM; ++ch) {
+            auto first = std::find_if(period.outputs.begin(), period.outputs.end(), [ch](uint8_t outputs) {
+                return outputs & (1U << ch);
+            });
+            auto early = first != period.outputs.end() &&
+                         uint32_t(first - period.outputs.begin()) < Heater::MIN_START + active[ch].start;
+            overruns += early || period.onTicks[ch] > std::max(active[ch].ticks, latency);
+        }
+    }
+    std::fprintf(stderr,
+                 "timeline: %zu periods, settle up to %u ticks, interrupt latency up to %u ticks, %zu missed triggers, "
+                 "%zu periods on during the TC conversions, %zu in the settle window without latency, worst %u ticks "
+                 "into it with the late interrupts, %zu on-times over the request\n",
+                 PERIODS,
+                 MAX_SETTLE,
+                 maxLatency,
+                 missedTriggers,
+                 conversionOverlaps,
+                 settleOverlaps,
+                 worstIntrusion,
+                 overruns);
+    return missedTriggers || conversionOverlaps || settleOverlaps || overruns ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -21,14 +21,20 @@
  */
 
 #include "backlight.h"
+#include "barcode.h"
 #include "chlog.h"
+#include "display_handler.h"
+#include "heater.h"
 #include "input_handler.h"
 #include "lvgl.h"
+#include "mono_draw.h"
 #include "monofonts.h"
 #include "s1d157xx.h"
 #include "shiftreg.h"
+#include "temp_control.h"
 #include "ui.h"
 #include "ui_config.h"
+#include <algorithm>
 
 namespace Ui {
 
@@ -51,21 +57,41 @@ static inline void Init()
 using ShiftRegBus = ShiftReg<uint8_t, Pins::Clk, Pins::A0_Dat, Nullpin, Pins::KeysIn>;
 using Display = S1d157xx<S1D15710, ShiftRegBus, Pins::Cs, Pins::A0_Dat, Pins::Res>;
 
-constexpr size_t RAW_BUF_SIZE = (Display::Props::X_DIM)*24;
+// LVGL accounts the buffer in lv_color_t units and may index it per pixel (layers, the blend sources),
+// so it gets the count the buffer holds: a page of rows per pass, drawn page-packed into the first bytes
+constexpr size_t RAW_BUF_SIZE = MonoDraw::BufferSize(Display::Props::X_DIM, Display::Props::Y_DIM);
+constexpr size_t RAW_BUF_PIXELS = RAW_BUF_SIZE / sizeof(lv_color_t);
+static_assert(RAW_BUF_PIXELS >= Display::Props::X_DIM * 8, "A pass must hold a page");
+
+// The keys are read through the display bus, a scan must not break into a flush
+static MUTEX_DECL(busLock);
+
+constexpr eventmask_t EVT_INPUT = EVENT_MASK(0);
+constexpr eventmask_t EVT_REFRESH = EVENT_MASK(1);
+constexpr eventmask_t EVT_BENCHMARK = EVENT_MASK(2);
 
 static lv_disp_drv_t disp_drv;
 static lv_disp_draw_buf_t disp_buf;
-static lv_color_t raw_buf[RAW_BUF_SIZE];
+static uint8_t raw_buf[RAW_BUF_SIZE];
+
+static thread_t* displayThread;
+static Drivers::Heater::Channel selectedIron = Drivers::Heater::IRON_1;
+static FrameStats frameStats;
+static bool frameRendered;
+static uint32_t benchmarkFrames;
+static BSEMAPHORE_DECL(benchmarkDone, true);
 
 static void flush_cb(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p);
 static void rounder_cb(lv_disp_drv_t* disp_drv, lv_area_t* area);
-static void set_px_cb(lv_disp_drv_t* disp_drv,
-                      uint8_t* buf,
-                      lv_coord_t buf_w,
-                      lv_coord_t x,
-                      lv_coord_t y,
-                      lv_color_t color,
-                      lv_opa_t opa);
+static void monitor_cb(lv_disp_drv_t* disp_drv, uint32_t time, uint32_t px);
+
+static Input::raw_event_t ReadKeys()
+{
+    chMtxLock(&busLock);
+    auto result = ShiftRegBus::Read();
+    chMtxUnlock(&busLock);
+    return result;
+}
 
 static void event_handler(lv_event_t* e)
 {
@@ -99,16 +125,123 @@ static void event_handler(lv_event_t* e)
 //     }
 // }
 
+static void SelectIron(Drivers::Heater::Channel ch)
+{
+    selectedIron = ch;
+    Barcode::SelectIron(ch);
+}
+
+// The step grows while the key is held
+static void AdjustSetpoint(int direction, uint16_t repeats)
+{
+    auto step = direction * SETPOINT_STEP * Input::RepeatStep(repeats);
+    auto setpoint = std::clamp(Control::GetSetpoint(selectedIron) + float(step), 0.0f, Control::MAX_SETPOINT);
+    Control::SetSetpoint(selectedIron, setpoint);
+}
+
+static bool HandleInput()
+{
+    bool handled{};
+    Input::KeyEvent event;
+    while(Input::GetEvent(event)) {
+        // The iron keys pick the iron for the up/down keys and the tip scanner, no screen handles the keys yet
+        if(event.action == Input::Action::PRESS) {
+            switch(event.key) {
+                case Input::EV_IRON_1:
+                    SelectIron(Drivers::Heater::IRON_1);
+                    break;
+                case Input::EV_IRON_2:
+                    SelectIron(Drivers::Heater::IRON_2);
+                    break;
+                case Input::EV_IRON_3:
+                    SelectIron(Drivers::Heater::IRON_3);
+                    break;
+                default:
+                    break;
+            }
+        }
+        if(event.action == Input::Action::PRESS || event.action == Input::Action::REPEAT) {
+            if(event.key == Input::EV_CONTEXT_1) {
+                AdjustSetpoint(1, event.repeats);
+            }
+            else if(event.key == Input::EV_CONTEXT_2) {
+                AdjustSetpoint(-1, event.repeats);
+            }
+        }
+        handled = true;
+    }
+    return handled;
+}
+
+// The cutoff latches until reset, the control requests a refresh on the edge
+static void ShowCutOff(lv_obj_t* alert)
+{
+    if(Drivers::Heater::IsCutOff() && lv_obj_has_flag(alert, LV_OBJ_FLAG_HIDDEN)) {
+        lv_obj_clear_flag(alert, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+// Runs the LVGL timers (or a forced refresh) and accounts the frame, if one was rendered
+template<typename F>
+static void Render(F&& run)
+{
+    frameRendered = false;
+    auto start = chSysGetRealtimeCounterX();
+    run();
+    uint32_t elapsed = chSysGetRealtimeCounterX() - start;
+    chSysLock();
+    if(frameRendered) {
+        ++frameStats.rendered;
+        frameStats.renderCycles = elapsed;
+        frameStats.renderCyclesMax = std::max(frameStats.renderCyclesMax, elapsed);
+    }
+    else {
+        ++frameStats.skipped;
+    }
+    chSysUnlock();
+}
+
+// The whole screen of ui_init() invalidated and redrawn, the flush included
+static void Benchmark()
+{
+    rttime_t cycles{};
+    for(uint32_t frame{}; frame < benchmarkFrames; ++frame) {
+        lv_obj_invalidate(lv_scr_act());
+        auto start = chSysGetRealtimeCounterX();
+        lv_refr_now(nullptr);
+        cycles += chSysGetRealtimeCounterX() - start;
+    }
+    chSysLock();
+    frameStats.benchmarkFrames = benchmarkFrames;
+    frameStats.benchmarkCycles = benchmarkFrames ? uint32_t(cycles / benchmarkFrames) : 0;
+    chSysUnlock();
+    chBSemSignal(&benchmarkDone);
+}
+
 static THD_WORKING_AREA(HANDLER_WA_SIZE, 2048);
 static THD_FUNCTION(displayHandler, )
 {
     auto l = ui_init();
-    Input::EventHandler evHandler{ShiftRegBus::Read};
+    auto cutOffAlert = ui_alert_create("OVERHEAT: HEATERS OFF");
+    event_listener_t inputListener;
+    chEvtRegisterMask(Input::GetEventSource(), &inputListener, EVT_INPUT);
+    Input::Init(ReadKeys);
+    // The refresh timer caps the frame rate, LVGL pauses it while nothing is invalidated
+    lv_timer_set_period(_lv_disp_get_refr_timer(lv_disp_get_default()), 1000 / MAX_FRAME_RATE);
+    uint32_t nextTimerMs{};
     while(true) {
         //        ui_handler(l);
-        lv_timer_handler();
-        evHandler.ProcessEvent();
-        chThdSleepMilliseconds(LV_TIMER_POLL_MS);
+        auto events = chEvtWaitAnyTimeout(ALL_EVENTS, TIME_MS2I(std::clamp<uint32_t>(nextTimerMs, 1, IDLE_WAKE_MS)));
+        chEvtGetAndClearFlags(&inputListener);
+        ShowCutOff(cutOffAlert);
+        if((events & EVT_INPUT) && HandleInput()) {
+            // Shortest path from a key to the screen, skips the refresh period
+            Render([] { lv_refr_now(nullptr); });
+        }
+        Render([&] { nextTimerMs = lv_timer_handler(); });
+        if(events & EVT_BENCHMARK) {
+            Benchmark();
+        }
     }
 }
 
@@ -118,18 +251,19 @@ void Init()
     Pins::Init();
     Bl::Init();
     Display::Init();
-    lv_disp_draw_buf_init(&disp_buf, raw_buf, nullptr, RAW_BUF_SIZE);
+    lv_disp_draw_buf_init(&disp_buf, raw_buf, nullptr, RAW_BUF_PIXELS);
     lv_disp_drv_init(&disp_drv);
     disp_drv.draw_buf = &disp_buf;
     disp_drv.hor_res = Display::Props::X_DIM;
     disp_drv.ver_res = Display::Props::Y_DIM;
     disp_drv.flush_cb = flush_cb;
     disp_drv.rounder_cb = rounder_cb;
-    disp_drv.set_px_cb = set_px_cb;
+    disp_drv.monitor_cb = monitor_cb;
+    disp_drv.draw_ctx_init = MonoDraw::draw_ctx_init_cb;
     lv_disp_drv_register(&disp_drv);
 
-    auto* thd = chThdCreateStatic(HANDLER_WA_SIZE, sizeof(HANDLER_WA_SIZE), NORMALPRIO, displayHandler, nullptr);
-    chRegSetThreadNameX(thd, "display_handler");
+    displayThread = chThdCreateStatic(HANDLER_WA_SIZE, sizeof(HANDLER_WA_SIZE), NORMALPRIO, displayHandler, nullptr);
+    chRegSetThreadNameX(displayThread, "display_handler");
 
     lv_theme_t* th = lv_theme_mono_init(0, true, &lv_font_font5x7);
     lv_disp_set_theme(nullptr, th);
@@ -144,34 +278,56 @@ void flush_cb(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_
         lv_disp_flush_ready(disp_drv);
         return;
     }
-    uint8_t* buf8 = (uint8_t*)color_p;
+    auto* buf8 = (const uint8_t*)color_p;
     lv_coord_t x_len = area->x2 - area->x1 + 1;
 
     size_t y1 = area->y1 >> 3;
     size_t y2 = area->y2 >> 3;
+    chMtxLock(&busLock);
     for(size_t y = y1; y <= y2; ++y) {
         Display::PutPage(area->x1, x_len, y, buf8);
         buf8 += x_len;
     }
+    chMtxUnlock(&busLock);
     lv_disp_flush_ready(disp_drv);
 }
 
-void rounder_cb(lv_disp_drv_t*, lv_area_t* area)
+void RequestRefresh()
 {
-    // Round to 8 bit page size
-    area->y1 &= ~0x07;
-    area->y2 = (area->y2 | 0x07);
+    // The control runs before the display thread is started
+    if(displayThread) {
+        chEvtSignal(displayThread, EVT_REFRESH);
+    }
 }
 
-void set_px_cb(lv_disp_drv_t*, uint8_t* buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y, lv_color_t color, lv_opa_t)
+FrameStats GetFrameStats()
 {
-    buf += buf_w * (y >> 3) + x;
-    if(color.full) {
-        (*buf) |= (1 << (y % 8));
-    }
-    else {
-        (*buf) &= ~(1 << (y % 8));
+    chSysLock();
+    auto result = frameStats;
+    chSysUnlock();
+    return result;
+}
+
+void RunBenchmark(uint32_t frames)
+{
+    if(!displayThread) {
+        return;
     }
+    benchmarkFrames = frames;
+    chEvtSignal(displayThread, EVT_BENCHMARK);
+    chBSemWait(&benchmarkDone);
+}
+
+void monitor_cb(lv_disp_drv_t*, uint32_t, uint32_t)
+{
+    frameRendered = true;
+}
+
+void rounder_cb(lv_disp_drv_t*, lv_area_t* area)
+{
+    // Round to 8 bit page size
+    area->y1 &= ~0x07;
+    area->y2 = (area->y2 | 0x07);
 }
 
 } // Ui
@@ -23,10 +23,35 @@
 #ifndef DISPLAY_HANDLER_H
 #define DISPLAY_HANDLER_H
 
+#include <cstdint>
+
 namespace Ui {
 
+struct FrameStats
+{
+    uint32_t rendered;
+    uint32_t skipped; // Display thread wake-ups which didn't end up in a frame
+    uint32_t renderCycles;
+    uint32_t renderCyclesMax;
+    uint32_t benchmarkFrames;
+    uint32_t benchmarkCycles; // Mean cost of a whole screen frame in the last RunBenchmark()
+};
+
 void Init();
 
+/**
+ * @brief Wake the display thread to run the LVGL timers, for the state changed outside of the UI.
+ * The control calls it when a setpoint or the cutoff reaches the status.
+ */
+void RequestRefresh();
+FrameStats GetFrameStats();
+
+/**
+ * @brief Render and flush the whole screen the given number of times on the display thread, the cost goes
+ * to FrameStats. Returns when the frames are done.
+ */
+void RunBenchmark(uint32_t frames);
+
 } // Ui
 
 #endif // DISPLAY_HANDLER_H
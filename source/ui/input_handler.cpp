@@ -21,71 +21,47 @@
  */
 
 #include "input_handler.h"
-#include "ui_config.h"
+#include "spsc_ring.h"
 
 namespace Input {
 
-enum RawState : EventHandler::raw_event_t {
-    RAW_IDLE = 0x00,
-    RAW_IRON_1 = 0x04,
-    RAW_IRON_2 = 0x02,
-    RAW_IRON_3 = 0x01,
-    RAW_CONTEXT_1 = 0x08,
-    RAW_CONTEXT_2 = 0x10,
-    RAW_CONTEXT_3 = 0x20,
-    RAW_MENU = 0x40,
-};
+constexpr size_t QUEUE_SIZE = 16;
 
-constexpr auto LONG_TAP_CYCLES = LONG_TAP_MS / LV_TIMER_POLL_MS;
+static RawReaderCb readRaw;
+static Utils::SpscRing<KeyEvent, QUEUE_SIZE> events;
+static EVENTSOURCE_DECL(eventSource);
 
-void EventHandler::ProcessEvent()
+static THD_WORKING_AREA(SCAN_WA_SIZE, 256);
+static THD_FUNCTION(keyScan, )
 {
-    auto rawState = static_cast<RawState>(cb_());
-
-    if(rawState != RAW_IDLE) {
-        if(++cycleCounter_ == LONG_TAP_CYCLES) {
-            Emit(rawState, true);
-        }
-    }
-    else if(prevState_ != RAW_IDLE) {
-        Emit(rawState, false);
-    }
-    else {
-        cycleCounter_ = 0;
+    KeyScanner scanner;
+    systime_t next = chVTGetSystemTime();
+    while(true) {
+        next = chThdSleepUntilWindowed(next, chTimeAddX(next, TIME_MS2I(KEY_SCAN_MS)));
+        scanner.Process(readRaw(), next, [](const KeyEvent& event) {
+            // The oldest events are kept if nobody drains the queue
+            if(events.Push(event)) {
+                chEvtBroadcastFlags(&eventSource, event.key);
+            }
+        });
     }
-    prevState_ = rawState;
 }
 
-void EventHandler::Emit(raw_event_t rawEvent, bool longTap)
+void Init(RawReaderCb reader)
 {
-    eventmask_t events{};
-    switch(rawEvent) {
-    case RAW_IRON_1:
-        events |= EV_IRON_1;
-        break;
-    case RAW_IRON_2:
-        events |= EV_IRON_2;
-        break;
-    case RAW_IRON_3:
-        events |= EV_IRON_2;
-        break;
-    case RAW_CONTEXT_1:
-        events |= EV_CONTEXT_1;
-        break;
-    case RAW_CONTEXT_2:
-        events |= EV_CONTEXT_2;
-        break;
-    case RAW_CONTEXT_3:
-        events |= EV_CONTEXT_3;
-        break;
-    case RAW_MENU:
-        events |= EV_MODE_MENU;
-        break;
-    case RAW_IDLE:
-        break;
-    }
-    events |= longTap ? EV_PUSH_LONG : 0;
-    chEvtBroadcastFlags(&source_, events);
+    readRaw = reader;
+    auto* thd = chThdCreateStatic(SCAN_WA_SIZE, sizeof(SCAN_WA_SIZE), NORMALPRIO + 1, keyScan, nullptr);
+    chRegSetThreadNameX(thd, "key_scan");
+}
+
+bool GetEvent(KeyEvent& event)
+{
+    return events.Pop(event);
+}
+
+event_source_t* GetEventSource()
+{
+    return &eventSource;
 }
 
 } // Input
@@ -24,6 +24,9 @@
 #define INPUT_HANDLER_H
 
 #include "hal.h"
+#include "ui_config.h"
+#include <algorithm>
+#include <array>
 
 namespace Input {
 
@@ -35,29 +38,141 @@ enum Event {
     EV_IRON_1 = 1U << 4,
     EV_IRON_2 = 1U << 5,
     EV_IRON_3 = 1U << 6,
+};
+
+enum class Action : uint8_t {
+    PRESS,
+    RELEASE,
+    LONG,   // Once per press, after LONG_TAP_MS
+    REPEAT, // After the long tap until release, with the period shrinking down to KEY_REPEAT_MIN_MS
+    CHORD,  // A key pressed while others are held, instead of PRESS
+};
 
-    EV_PUSH_LONG = 1U << 7,
+struct KeyEvent
+{
+    Event key;
+    Action action;
+    uint8_t chord;    // Event mask of the chord the key belongs to, zero for a single key
+    uint16_t repeats; // Number of the REPEAT event since the long tap
+    systime_t time;   // Scan that detected the debounced change
 };
 
-class EventHandler
+/**
+ * @brief Step multiplier for value adjustment by the repeated events: x1 for the first ones, up to x10
+ */
+constexpr int RepeatStep(uint16_t repeats)
+{
+    return repeats < 10 ? 1 : repeats < 25 ? 5 : 10;
+}
+
+using raw_event_t = uint8_t;
+using RawReaderCb = raw_event_t (*)();
+
+/**
+ * @brief Debounces the raw key bits with a 2-bit vertical counter: a key changes its state after
+ * four equal samples in a row. All the keys are processed at once and independently.
+ * A key pressed while others are held makes a chord; the keys in a chord don't produce
+ * LONG/REPEAT events and their RELEASE events carry the chord mask.
+ */
+class KeyScanner
 {
 public:
-    using raw_event_t = uint8_t;
-    using RawReaderCb = raw_event_t (*)();
-    EventHandler(RawReaderCb cb) : cb_{cb}
+    static constexpr size_t KEYS_NUM = 7;
+    // Shift register bit order
+    static constexpr Event KEY_MAP[KEYS_NUM] = {
+      EV_IRON_3, EV_IRON_2, EV_IRON_1, EV_CONTEXT_1, EV_CONTEXT_2, EV_CONTEXT_3, EV_MODE_MENU,
+    };
+
+    template<typename EmitFn>
+    void Process(raw_event_t raw, systime_t now, EmitFn&& emit)
+    {
+        raw_event_t changed = state_ ^ raw;
+        ct0_ = ~(ct0_ & changed);
+        ct1_ = ct0_ ^ (ct1_ & changed);
+        changed &= ct0_ & ct1_;
+        auto held = state_ & ~changed;
+        state_ ^= changed;
+        raw_event_t pressed = changed & state_;
+        if(pressed && (held || (pressed & (pressed - 1)))) {
+            chord_ |= state_;
+        }
+        for(size_t i{}; i < KEYS_NUM; ++i) {
+            raw_event_t bit = 1U << i;
+            uint8_t chord = (chord_ & bit) ? ToEvents(chord_) : 0;
+            if(changed & bit) {
+                if(state_ & bit) {
+                    pressedAt_[i] = now;
+                    nextRepeat_[i] = LONG_TAP;
+                    interval_[i] = REPEAT;
+                    repeats_[i] = 0;
+                    emit(KeyEvent{KEY_MAP[i], chord ? Action::CHORD : Action::PRESS, chord, 0, now});
+                }
+                else {
+                    emit(KeyEvent{KEY_MAP[i], Action::RELEASE, chord, repeats_[i], now});
+                }
+            }
+            else if((state_ & bit) && !chord && chTimeDiffX(pressedAt_[i], now) >= nextRepeat_[i]) {
+                bool isLong = nextRepeat_[i] == LONG_TAP;
+                auto repeats = isLong ? repeats_[i] : ++repeats_[i];
+                emit(KeyEvent{KEY_MAP[i], isLong ? Action::LONG : Action::REPEAT, 0, repeats, now});
+                if(!isLong) {
+                    // Accelerate by a quarter each repeat
+                    interval_[i] = std::max(interval_[i] - interval_[i] / 4, REPEAT_MIN);
+                }
+                nextRepeat_[i] += interval_[i];
+            }
+        }
+        // The chord is over once all of its keys are released
+        if(!(chord_ & state_)) {
+            chord_ = 0;
+        }
+    }
+
+    raw_event_t GetState() const
     {
-        chEvtObjectInit(&source_);
+        return state_;
     }
-    void ProcessEvent();
 private:
-    RawReaderCb cb_;
-    raw_event_t prevState_{};
-    size_t cycleCounter_{};
-    event_source_t source_;
+    static constexpr sysinterval_t LONG_TAP = TIME_MS2I(LONG_TAP_MS);
+    static constexpr sysinterval_t REPEAT = TIME_MS2I(KEY_REPEAT_MS);
+    static constexpr sysinterval_t REPEAT_MIN = TIME_MS2I(KEY_REPEAT_MIN_MS);
+
+    static constexpr uint8_t ToEvents(raw_event_t raw)
+    {
+        uint8_t result{};
+        for(size_t i{}; i < KEYS_NUM; ++i) {
+            if(raw & (1U << i)) {
+                result |= KEY_MAP[i];
+            }
+        }
+        return result;
+    }
 
-    void Emit(raw_event_t rawEvent, bool longTap);
+    raw_event_t state_{};
+    raw_event_t ct0_{0xFF}, ct1_{0xFF};
+    raw_event_t chord_{};
+    std::array<systime_t, KEYS_NUM> pressedAt_{};
+    std::array<sysinterval_t, KEYS_NUM> nextRepeat_{};
+    std::array<sysinterval_t, KEYS_NUM> interval_{};
+    std::array<uint16_t, KEYS_NUM> repeats_{};
 };
 
+/**
+ * @brief Start the key scan thread, it samples the keys every KEY_SCAN_MS.
+ * @param reader is called from the scan thread, it has to serialize the access to the shared bus itself
+ */
+void Init(RawReaderCb reader);
+
+/**
+ * @brief Pop the oldest key event, non-blocking
+ */
+bool GetEvent(KeyEvent& event);
+
+/**
+ * @brief Broadcasts the Event flags of the keys for every queued event
+ */
+event_source_t* GetEventSource();
+
 } // Input
 
 #endif // INPUT_HANDLER_H
@@ -106,3 +106,19 @@ lv_obj_t* ui_init()
     lv_obj_set_scrollbar_mode(marker, LV_SCROLLBAR_MODE_OFF);
     return temp_actual;
 }
+
+lv_obj_t* ui_alert_create(const char* text)
+{
+    auto alert = lv_obj_create(lv_layer_top());
+    lv_obj_set_size(alert, lv_pct(100), 21);
+    lv_obj_center(alert);
+    Styles::add(alert, Styles::box_iron_section);
+    lv_obj_set_scrollbar_mode(alert, LV_SCROLLBAR_MODE_OFF);
+
+    auto label = lv_label_create(alert);
+    lv_label_set_text_static(label, text);
+    lv_obj_center(label);
+    Styles::add(label, Styles::font_normal);
+    lv_obj_add_flag(alert, LV_OBJ_FLAG_HIDDEN);
+    return alert;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "mono_draw.h"
+#include "page_buffer.h"
+#include <type_traits>
+
+namespace MonoDraw {
+
+static_assert(std::is_same_v<lv_coord_t, coord_t>);
+
+static PageBuf pageBuf(lv_draw_ctx_t* draw_ctx)
+{
+    return {(uint8_t*)draw_ctx->buf,
+            draw_ctx->buf_area->x1,
+            draw_ctx->buf_area->y1,
+            lv_area_get_width(draw_ctx->buf_area)};
+}
+
+static void blend_cb(lv_draw_ctx_t* draw_ctx, const lv_draw_sw_blend_dsc_t* dsc)
+{
+    if(dsc->opa <= LV_OPA_MIN || dsc->mask_res == LV_DRAW_MASK_RES_TRANSP) {
+        return;
+    }
+    lv_area_t area;
+    if(!_lv_area_intersect(&area, dsc->blend_area, draw_ctx->clip_area)) {
+        return;
+    }
+    auto pb = pageBuf(draw_ctx);
+    const lv_opa_t* mask = dsc->mask_res == LV_DRAW_MASK_RES_FULL_COVER ? nullptr : dsc->mask_buf;
+    if(!mask && !dsc->src_buf) {
+        fill(pb, area, dsc->color.full);
+        return;
+    }
+    // Any non-transparent mask pixel is drawn, same as the generic set_px path did
+    auto srcStride = lv_area_get_width(dsc->blend_area);
+    auto maskStride = mask ? lv_area_get_width(dsc->mask_area) : 0;
+    for(auto y = area.y1; y <= area.y2; ++y) {
+        auto bit = PageBuf::bit(y);
+        auto* col = pb.column(area.x1, y);
+        auto* maskRow = mask ? &mask[(y - dsc->mask_area->y1) * maskStride - dsc->mask_area->x1] : nullptr;
+        auto* srcRow = dsc->src_buf ? &dsc->src_buf[(y - dsc->blend_area->y1) * srcStride - dsc->blend_area->x1]
+                                    : nullptr;
+        for(auto x = area.x1; x <= area.x2; ++x, ++col) {
+            if(maskRow && !maskRow[x]) {
+                continue;
+            }
+            auto set = srcRow ? srcRow[x].full : dsc->color.full;
+            *col = set ? (*col | bit) : (*col & ~bit);
+        }
+    }
+}
+
+// A1 glyphs are copied bit by bit from the font bitmap, without an intermediate opacity mask
+static void draw_letter_cb(lv_draw_ctx_t* draw_ctx,
+                           const lv_draw_label_dsc_t* dsc,
+                           const lv_point_t* pos_p,
+                           uint32_t letter)
+{
+    lv_font_glyph_dsc_t g;
+    if(dsc->opa <= LV_OPA_MIN || !lv_font_get_glyph_dsc(dsc->font, &g, letter, '\0') || g.bpp != 1 ||
+       dsc->decor != LV_TEXT_DECOR_NONE) {
+        // Let the generic renderer deal with missing glyphs and decorations
+        lv_draw_sw_letter(draw_ctx, dsc, pos_p, letter);
+        return;
+    }
+    if(!g.box_w || !g.box_h) {
+        return;
+    }
+    lv_area_t letterArea;
+    letterArea.x1 = pos_p->x + g.ofs_x;
+    letterArea.y1 = pos_p->y + (dsc->font->line_height - dsc->font->base_line) - g.box_h - g.ofs_y;
+    letterArea.x2 = letterArea.x1 + g.box_w - 1;
+    letterArea.y2 = letterArea.y1 + g.box_h - 1;
+    lv_area_t area;
+    if(!_lv_area_intersect(&area, &letterArea, draw_ctx->clip_area)) {
+        return;
+    }
+    auto* bitmap = lv_font_get_glyph_bitmap(g.resolved_font, letter);
+    if(!bitmap) {
+        return;
+    }
+    blit(pageBuf(draw_ctx), bitmap, letterArea, area, dsc->color.full);
+}
+
+void draw_ctx_init_cb(lv_disp_drv_t* drv, lv_draw_ctx_t* draw_ctx)
+{
+    lv_draw_sw_init_ctx(drv, draw_ctx);
+    auto* swCtx = (lv_draw_sw_ctx_t*)draw_ctx;
+    swCtx->blend = blend_cb;
+    draw_ctx->draw_letter = draw_letter_cb;
+}
+
+} // MonoDraw
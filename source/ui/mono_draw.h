@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MONO_DRAW_H
+#define MONO_DRAW_H
+
+#include "lvgl.h"
+
+namespace MonoDraw {
+
+/**
+ * @brief Software draw context that renders straight into the S1D157xx page format.
+ * Every byte of the draw buffer holds 8 vertical pixels, LSB on top, pages follow each other
+ * with the stride of the buffer area width. The buffer area must be aligned to the page height.
+ */
+void draw_ctx_init_cb(lv_disp_drv_t* drv, lv_draw_ctx_t* draw_ctx);
+
+/**
+ * @brief Draw buffer size in bytes required for the area of the given dimensions
+ */
+constexpr size_t BufferSize(size_t width, size_t height)
+{
+    return width * ((height + 7) / 8);
+}
+
+} // MonoDraw
+
+#endif // MONO_DRAW_H
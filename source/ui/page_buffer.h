@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAGE_BUFFER_H
+#define PAGE_BUFFER_H
+
+#include <algorithm>
+#include <cstdint>
+
+namespace MonoDraw {
+
+using coord_t = int16_t;
+
+/**
+ * @brief Draw buffer in the S1D157xx page format: every byte holds 8 vertical pixels, LSB on top,
+ * pages follow each other with the stride of the buffer width. The buffer starts at a page boundary.
+ * The drawing below takes any area type with the inclusive x1/y1/x2/y2 corners, lv_area_t included.
+ */
+struct PageBuf
+{
+    uint8_t* data;
+    coord_t x1, y1, stride;
+
+    uint8_t* column(coord_t x, coord_t y) const
+    {
+        return data + ((y - y1) >> 3) * stride + (x - x1);
+    }
+    // The buffer area starts at a page boundary, so the bit position is absolute
+    static uint8_t bit(coord_t y)
+    {
+        return 1U << (y & 0x07);
+    }
+    void put(coord_t x, coord_t y, bool set) const
+    {
+        auto* col = column(x, y);
+        if(set) {
+            *col |= bit(y);
+        }
+        else {
+            *col &= ~bit(y);
+        }
+    }
+};
+
+// Solid rectangle: whole page bytes are updated at once, a partial mask only for the first and last page
+template<typename Area>
+void fill(const PageBuf& pb, const Area& area, bool set)
+{
+    for(auto y = area.y1; y <= area.y2;) {
+        auto pageEnd = coord_t(y | 0x07);
+        auto yEnd = std::min<coord_t>(pageEnd, area.y2);
+        uint8_t mask = (0xFF << (y & 0x07)) & (0xFF >> (7 - (yEnd & 0x07)));
+        auto* col = pb.column(area.x1, y);
+        for(auto x = area.x1; x <= area.x2; ++x, ++col) {
+            *col = set ? (*col | mask) : (*col & ~mask);
+        }
+        y = yEnd + 1;
+    }
+}
+
+/**
+ * @brief Set bits of an A1 bitmap, rows packed back to back MSB first, drawn over the clipped part of its area
+ */
+template<typename Area>
+void blit(const PageBuf& pb, const uint8_t* bitmap, const Area& bitmapArea, const Area& area, bool set)
+{
+    auto width = bitmapArea.x2 - bitmapArea.x1 + 1;
+    for(auto y = area.y1; y <= area.y2; ++y) {
+        uint32_t bitIndex = (y - bitmapArea.y1) * width + (area.x1 - bitmapArea.x1);
+        for(auto x = area.x1; x <= area.x2; ++x, ++bitIndex) {
+            if(bitmap[bitIndex >> 3] & (0x80 >> (bitIndex & 0x07))) {
+                pb.put(x, y, set);
+            }
+        }
+    }
+}
+
+} // MonoDraw
+
+#endif // PAGE_BUFFER_H
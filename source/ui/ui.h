@@ -26,5 +26,7 @@
 #include "lvgl.h"
 
 lv_obj_t* ui_init();
+// Hidden box over the screen for a latched fault, clear LV_OBJ_FLAG_HIDDEN to show it
+lv_obj_t* ui_alert_create(const char* text);
 
 #endif // UI_H
@@ -23,7 +23,14 @@
 #ifndef UI_CONFIG_H
 #define UI_CONFIG_H
 
-constexpr auto LV_TIMER_POLL_MS = 10;
+constexpr auto MAX_FRAME_RATE = 30;
+// Upper bound of the display thread sleep when no LVGL timer is running
+constexpr auto IDLE_WAKE_MS = 1000U;
 constexpr auto LONG_TAP_MS = 500;
+constexpr auto KEY_SCAN_MS = 5;
+constexpr auto KEY_REPEAT_MS = 150;
+constexpr auto KEY_REPEAT_MIN_MS = 30;
+// Celsius per up/down key press, Input::RepeatStep() multiplies it while the key is held
+constexpr auto SETPOINT_STEP = 1;
 
 #endif // UI_CONFIG_H
@@ -26,14 +26,14 @@
 // clang-format off
 #include "hal.h"
 #include "chprintf.h"
+#include "deferred_log.h"
 #include "hal_streams.h"
 // clang-format on
 
 /*
  * Custom defines
  */
-#define CHLOG(...)                                      \
-    chprintf((BaseSequentialStream*)&SD2, __VA_ARGS__); \
-    streamWrite((BaseSequentialStream*)&SD2, (const uint8_t*)"\r\n", 2);
+// Formatted on the host from the telemetry link, see DeferredLog::Write() for the argument restrictions
+#define CHLOG(...) DeferredLog::Write(__VA_ARGS__)
 
 #endif // CHLOG_H
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef COBS_H
+#define COBS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Utils {
+
+/**
+ * @brief Consistent Overhead Byte Stuffing, the encoded frame has no zero bytes so a zero delimits the frames
+ */
+class CobsEncoder
+{
+public:
+    static constexpr size_t MaxEncodedSize(size_t len)
+    {
+        return len + len / 254 + 1;
+    }
+
+    CobsEncoder(uint8_t* dst, size_t capacity) : dst_{dst}, capacity_{capacity}
+    {
+        Reserve();
+    }
+
+    bool Put(uint8_t byte)
+    {
+        if(byte) {
+            if(!Append(byte)) {
+                return false;
+            }
+            if(++code_ == 0xFF) {
+                return Close();
+            }
+            return true;
+        }
+        return Close();
+    }
+
+    bool Put(const uint8_t* buf, size_t len)
+    {
+        for(size_t i{}; i < len; ++i) {
+            if(!Put(buf[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Close the last block and append the delimiter
+     * @return The frame length or zero if it didn't fit
+     */
+    size_t Finish()
+    {
+        if(overflow_) {
+            return 0;
+        }
+        dst_[codePos_] = code_;
+        if(!Append(0)) {
+            return 0;
+        }
+        return len_;
+    }
+
+private:
+    bool Append(uint8_t byte)
+    {
+        if(len_ == capacity_) {
+            overflow_ = true;
+            return false;
+        }
+        dst_[len_++] = byte;
+        return true;
+    }
+
+    void Reserve()
+    {
+        codePos_ = len_;
+        code_ = 1;
+        Append(0);
+    }
+
+    bool Close()
+    {
+        if(overflow_) {
+            return false;
+        }
+        dst_[codePos_] = code_;
+        Reserve();
+        return !overflow_;
+    }
+
+    uint8_t* dst_;
+    size_t capacity_;
+    size_t len_{};
+    size_t codePos_{};
+    uint8_t code_{};
+    bool overflow_{};
+};
+
+/**
+ * @brief Decode a frame in place, the output never overtakes the input
+ * @param len Frame length without the delimiter
+ * @return The decoded length or zero for a malformed frame
+ */
+inline size_t CobsDecode(uint8_t* buf, size_t len)
+{
+    size_t in{}, out{};
+    while(in < len) {
+        uint8_t code = buf[in++];
+        if(!code || in + code - 1 > len) {
+            return 0;
+        }
+        for(size_t i{1}; i < code; ++i) {
+            buf[out++] = buf[in++];
+        }
+        if(code != 0xFF && in < len) {
+            buf[out++] = 0;
+        }
+    }
+    return out;
+}
+
+} // Utils
+
+#endif // COBS_H
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CONFIG_LOG_H
+#define CONFIG_LOG_H
+
+#include "ch_extended.h"
+#include "crc16.h"
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+namespace Config {
+
+using Rtos::Status;
+
+template<typename T>
+concept PageStorageType = requires(uint16_t address, uint8_t* buf, const uint8_t* cbuf, size_t len) {
+    { T::PAGE_SIZE } -> std::convertible_to<size_t>;
+    { T::Read(address, buf, len) } -> std::same_as<Status>;
+    { T::WritePage(address, cbuf, len) } -> std::same_as<Status>;
+};
+
+/**
+ * @brief Log structured key/value store on a ring of EEPROM pages.
+ * Every write is one full page with a sequence number, a batch of changed records and a CRC, the page slot
+ * is the sequence number modulo the ring size, so the pages wear evenly. The latest record of a key wins.
+ * Records living in the page to be overwritten next are carried into the page being written, so a torn
+ * write loses at most the batch it carries.
+ */
+template<PageStorageType Storage, size_t KEYS_NUM, size_t LOG_PAGES, uint16_t BASE_ADDRESS = 0>
+class Log
+{
+public:
+    using value_t = int16_t;
+
+    static_assert(Storage::PAGE_SIZE == 32, "The page layout is made for 32 byte pages");
+    static_assert(65536 % LOG_PAGES == 0, "The sequence number wraps must keep the slot order");
+    static_assert(KEYS_NUM <= 64 && KEYS_NUM < 0xFF);
+
+    struct Stats
+    {
+        uint32_t pagesWritten;
+        uint32_t pagesLoaded;
+        uint32_t corruptPages; // Failed CRC at load, torn writes or never written pages
+    };
+
+    /**
+     * @brief Replay the whole log in one sequential pass, the order of the pages doesn't matter.
+     * Store() is refused until a Load() succeeds, the next sequence number isn't known before.
+     * @param apply called with (key, value) for every key found, only when the whole log was read
+     */
+    template<typename F>
+    Status Load(F&& apply)
+    {
+        // A failed pass may have left a part of the log behind
+        loaded_ = false;
+        persisted_ = {};
+        lastSeq_ = {};
+        present_ = {};
+        bool any{};
+        uint16_t newest{};
+        uint32_t pagesLoaded{}, corruptPages{};
+        for(size_t slot{}; slot < LOG_PAGES; slot += CHUNK_PAGES) {
+            if(Storage::Read(BASE_ADDRESS + slot * PAGE_SIZE, chunk_[0].data(), sizeof(chunk_)) != Status::Success) {
+                return Status::Failure;
+            }
+            for(const auto& page : chunk_) {
+                if(!IsValid(page)) {
+                    ++corruptPages;
+                    continue;
+                }
+                ++pagesLoaded;
+                auto seq = GetSeq(page);
+                if(!any || IsNewer(seq, newest)) {
+                    newest = seq;
+                    any = true;
+                }
+                for(size_t i{}; i < page[COUNT_OFFSET]; ++i) {
+                    const auto* record = &page[RECORDS_OFFSET + i * RECORD_SIZE];
+                    auto key = record[0];
+                    if(key < KEYS_NUM && (!(present_ & Bit(key)) || IsNewer(seq, lastSeq_[key]))) {
+                        persisted_[key] = value_t(record[1] | record[2] << 8);
+                        lastSeq_[key] = seq;
+                        present_ |= Bit(key);
+                    }
+                }
+            }
+        }
+        nextSeq_ = any ? uint16_t(newest + 1) : 0;
+        loaded_ = true;
+        stats_.pagesLoaded += pagesLoaded;
+        stats_.corruptPages += corruptPages;
+        for(size_t key{}; key < KEYS_NUM; ++key) {
+            if(present_ & Bit(key)) {
+                apply(key, persisted_[key]);
+            }
+        }
+        return Status::Success;
+    }
+
+    bool IsLoaded() const
+    {
+        return loaded_;
+    }
+
+    /**
+     * @brief Write the keys which differ from the stored ones, nothing is written if none changed.
+     * @param mask keys to be stored, the rest are ignored
+     * @return Failure without writing anything while the log isn't loaded, the slots of the live pages are unknown
+     */
+    Status Store(const std::array<value_t, KEYS_NUM>& values, uint64_t mask)
+    {
+        if(!loaded_) {
+            return Status::Failure;
+        }
+        uint64_t pending{};
+        for(size_t key{}; key < KEYS_NUM; ++key) {
+            if((mask & Bit(key)) && (!(present_ & Bit(key)) || persisted_[key] != values[key])) {
+                pending |= Bit(key);
+            }
+        }
+        while(pending || CarryMask(uint16_t(nextSeq_ - LOG_PAGES))) {
+            auto seq = nextSeq_;
+            // Records of the overwritten page and of the next one go first
+            auto carry = CarryMask(uint16_t(seq - LOG_PAGES + 1));
+            Page page{};
+            uint64_t written{};
+            size_t count{};
+            for(auto batch : {carry, pending}) {
+                for(size_t key{}; key < KEYS_NUM && count < RECORDS_NUM; ++key) {
+                    if((batch & Bit(key)) && !(written & Bit(key))) {
+                        auto value = (pending & Bit(key)) ? values[key] : persisted_[key];
+                        auto* record = &page[RECORDS_OFFSET + count++ * RECORD_SIZE];
+                        record[0] = uint8_t(key);
+                        record[1] = uint8_t(value);
+                        record[2] = uint8_t(value >> 8);
+                        written |= Bit(key);
+                    }
+                }
+            }
+            page[0] = uint8_t(seq);
+            page[1] = uint8_t(seq >> 8);
+            page[COUNT_OFFSET] = uint8_t(count);
+            auto crc = Utils::Crc16(page.data(), CRC_OFFSET);
+            page[CRC_OFFSET] = uint8_t(crc);
+            page[CRC_OFFSET + 1] = uint8_t(crc >> 8);
+            auto address = uint16_t(BASE_ADDRESS + (seq % LOG_PAGES) * PAGE_SIZE);
+            if(Storage::WritePage(address, page.data(), PAGE_SIZE) != Status::Success) {
+                return Status::Failure;
+            }
+            ++stats_.pagesWritten;
+            ++nextSeq_;
+            for(size_t key{}; key < KEYS_NUM; ++key) {
+                if(written & Bit(key)) {
+                    if(pending & Bit(key)) {
+                        persisted_[key] = values[key];
+                    }
+                    lastSeq_[key] = seq;
+                    present_ |= Bit(key);
+                }
+            }
+            pending &= ~written;
+        }
+        return Status::Success;
+    }
+
+    Stats GetStats() const
+    {
+        return stats_;
+    }
+private:
+    static constexpr size_t PAGE_SIZE = Storage::PAGE_SIZE;
+    // seq(2) count(1) records(9 * 3) crc(2)
+    static constexpr size_t COUNT_OFFSET = 2;
+    static constexpr size_t RECORDS_OFFSET = 3;
+    static constexpr size_t RECORD_SIZE = 3;
+    static constexpr size_t CRC_OFFSET = PAGE_SIZE - 2;
+    static constexpr size_t RECORDS_NUM = (CRC_OFFSET - RECORDS_OFFSET) / RECORD_SIZE;
+    static constexpr size_t CHUNK_PAGES = 8;
+    static_assert(LOG_PAGES % CHUNK_PAGES == 0);
+
+    using Page = std::array<uint8_t, PAGE_SIZE>;
+
+    static constexpr uint64_t Bit(size_t key)
+    {
+        return uint64_t{1} << key;
+    }
+
+    // Serial number arithmetic, valid while the live pages are within the ring
+    static constexpr bool IsNewer(uint16_t seq, uint16_t than)
+    {
+        return int16_t(seq - than) > 0;
+    }
+
+    static uint16_t GetSeq(const Page& page)
+    {
+        return uint16_t(page[0] | page[1] << 8);
+    }
+
+    static bool IsValid(const Page& page)
+    {
+        return page[COUNT_OFFSET] <= RECORDS_NUM &&
+               Utils::Crc16(page.data(), CRC_OFFSET) == uint16_t(page[CRC_OFFSET] | page[CRC_OFFSET + 1] << 8);
+    }
+
+    // Keys whose latest record is in the page with the given sequence number or older
+    uint64_t CarryMask(uint16_t seq) const
+    {
+        uint64_t mask{};
+        for(size_t key{}; key < KEYS_NUM; ++key) {
+            if((present_ & Bit(key)) && !IsNewer(lastSeq_[key], seq)) {
+                mask |= Bit(key);
+            }
+        }
+        return mask;
+    }
+
+    // Read buffer of Load(), too big for the stacks of the threads which load
+    std::array<Page, CHUNK_PAGES> chunk_;
+    std::array<value_t, KEYS_NUM> persisted_{};
+    std::array<uint16_t, KEYS_NUM> lastSeq_{};
+    uint64_t present_{};
+    uint16_t nextSeq_{};
+    bool loaded_{};
+    Stats stats_{};
+};
+
+} // Config
+
+#endif // CONFIG_LOG_H
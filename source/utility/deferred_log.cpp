@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "deferred_log.h"
+#include "spsc_ring.h"
+#include <atomic>
+
+namespace DeferredLog {
+
+constexpr size_t RING_WORDS = 64;
+constexpr auto DRAIN_INTERVAL = TIME_MS2I(20);
+
+// Record layout: time, format, count, args
+constexpr size_t HEADER_WORDS = 3;
+
+struct Writer
+{
+    Utils::SpscRing<word_t, RING_WORDS> ring;
+    std::atomic<uint32_t> dropped;
+};
+
+static Writer writers[MAX_WRITERS];
+static size_t writersUsed;
+static std::atomic<uint32_t> orphanDropped;
+static std::atomic<uint32_t> unboundDropped;
+static uint32_t records;
+static uint32_t sinkDropped;
+static Sink sink;
+
+// The ring is bound to the thread on its first record
+static Writer* GetWriter()
+{
+    auto* self = chThdGetSelfX();
+    if(self->log_writer) {
+        return static_cast<Writer*>(self->log_writer);
+    }
+    chSysLock();
+    if(writersUsed < MAX_WRITERS) {
+        self->log_writer = &writers[writersUsed++];
+    }
+    chSysUnlock();
+    return static_cast<Writer*>(self->log_writer);
+}
+
+bool Push(const char* fmt, const word_t* args, size_t count)
+{
+    if(port_is_isr_context()) {
+        orphanDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    auto* writer = GetWriter();
+    if(!writer) {
+        unboundDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    word_t record[HEADER_WORDS + MAX_ARGS]{word_t(chVTGetSystemTimeX()), word_t(fmt), word_t(count)};
+    for(size_t i{}; i < count; ++i) {
+        record[HEADER_WORDS + i] = args[i];
+    }
+    if(!writer->ring.Push(record, HEADER_WORDS + count)) {
+        writer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+// The oldest record among the rings, so the output keeps the time order
+static Writer* NextWriter(systime_t now)
+{
+    Writer* oldest{};
+    sysinterval_t oldestAge{};
+    for(size_t i{}; i < MAX_WRITERS; ++i) {
+        word_t time;
+        if(!writers[i].ring.Peek(time)) {
+            continue;
+        }
+        // Pushed after now was taken, the difference would wrap around and make it the oldest
+        auto ahead = int32_t(systime_t(time) - now) > 0;
+        auto age = ahead ? sysinterval_t{} : chTimeDiffX(systime_t(time), now);
+        if(!oldest || age > oldestAge) {
+            oldest = &writers[i];
+            oldestAge = age;
+        }
+    }
+    return oldest;
+}
+
+void Drain()
+{
+    auto now = chVTGetSystemTimeX();
+    while(auto* writer = NextWriter(now)) {
+        word_t record[HEADER_WORDS + MAX_ARGS];
+        writer->ring.Pop(record, HEADER_WORDS);
+        writer->ring.Pop(&record[HEADER_WORDS], record[2]);
+        ++records;
+        if(!sink(record, HEADER_WORDS + record[2])) {
+            ++sinkDropped;
+        }
+    }
+}
+
+static THD_WORKING_AREA(LOG_WA_SIZE, 512);
+static THD_FUNCTION(deferredLog, )
+{
+    while(true) {
+        chThdSleep(DRAIN_INTERVAL);
+        Drain();
+    }
+}
+
+void init(Sink out)
+{
+    sink = out;
+    auto* thd = chThdCreateStatic(LOG_WA_SIZE, sizeof(LOG_WA_SIZE), LOWPRIO, deferredLog, nullptr);
+    chRegSetThreadNameX(thd, "deferred_log");
+}
+
+Stats GetStats()
+{
+    auto unbound = unboundDropped.load(std::memory_order_relaxed);
+    Stats result{
+      .records = records,
+      .dropped = orphanDropped.load(std::memory_order_relaxed) + unbound + sinkDropped,
+      .unbound = unbound,
+    };
+    for(const auto& writer : writers) {
+        result.dropped += writer.dropped.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+} // DeferredLog
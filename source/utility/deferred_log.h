@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include "hal.h"
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace DeferredLog {
+
+// Pointer sized, the format string address is a record word
+using word_t = uintptr_t;
+
+constexpr size_t MAX_ARGS = 8;
+// A ring per logging thread, enough for all the firmware threads including main
+constexpr size_t MAX_WRITERS = 12;
+
+/**
+ * @brief Arguments are stored as raw words and formatted later: no floats, and %s only for the strings
+ * which outlive the record (literals)
+ */
+template<typename T>
+concept ArgType = (std::integral<T> || std::is_enum_v<T> || std::is_pointer_v<T>) && sizeof(T) <= sizeof(word_t);
+
+struct Stats
+{
+    uint32_t records;
+    uint32_t dropped; // Full ring or a call from an ISR
+    uint32_t unbound; // Records of the threads which came after all the rings were taken, included in dropped
+};
+
+/**
+ * @brief Takes a record: time, format address, argument count and the arguments, as many words as given.
+ * Nothing is formatted on the target, the host decoder looks the format up in the firmware image.
+ * @return false if the record was lost, it's counted as dropped
+ */
+using Sink = bool (*)(const word_t* record, size_t words);
+
+/**
+ * @brief Start the low priority thread which drains the rings into the sink
+ */
+void init(Sink out);
+
+/**
+ * @brief Hand the pending records to the sink, the oldest first. The log thread calls it periodically.
+ */
+void Drain();
+
+/**
+ * @brief Copy a record into the ring of the calling thread, thread context only.
+ * The format string address is the record id, nothing is formatted here.
+ */
+bool Push(const char* fmt, const word_t* args, size_t count);
+Stats GetStats();
+
+template<ArgType... Args>
+inline bool Write(const char* fmt, Args... args)
+{
+    static_assert(sizeof...(Args) <= MAX_ARGS, "Too many log arguments");
+    const word_t words[sizeof...(Args) + 1]{(word_t)(args)...};
+    return Push(fmt, words, sizeof...(Args));
+}
+
+} // DeferredLog
+
+#endif // DEFERRED_LOG_H
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FILTERS_H
+#define FILTERS_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+namespace Math {
+
+/**
+ * @brief A stage takes one sample and may give one: Process(in, out) returns true when out is set
+ */
+template<typename T>
+concept FilterStage = requires(T stage, int32_t in, int32_t& out) {
+    { stage.Process(in, out) } -> std::same_as<bool>;
+};
+
+/**
+ * @brief Sums N samples and gives one per N. EXTRA_BITS of the sum are kept as the fraction,
+ * 4^k oversampling gives k real bits on a noisy signal.
+ */
+template<size_t N, size_t EXTRA_BITS = 0>
+class Decimator
+{
+public:
+    static_assert(N && (N & (N - 1)) == 0, "Power of 2 to divide by a shift");
+
+    constexpr bool Process(int32_t in, int32_t& out)
+    {
+        sum_ += in;
+        if(++count_ < N) {
+            return false;
+        }
+        out = sum_ >> (SHIFT - EXTRA_BITS);
+        sum_ = 0;
+        count_ = 0;
+        return true;
+    }
+
+private:
+    static constexpr size_t SHIFT = std::countr_zero(N);
+    static_assert(EXTRA_BITS <= SHIFT);
+
+    int32_t sum_{};
+    size_t count_{};
+};
+
+/**
+ * @brief Median of the last N samples, a spike shorter than N/2 + 1 samples doesn't pass.
+ * Delays the signal by N/2 samples.
+ */
+template<size_t N>
+class RunningMedian
+{
+public:
+    static_assert(N % 2 == 1 && N <= 7, "Short odd windows only, sorted by insertion every sample");
+
+    constexpr bool Process(int32_t in, int32_t& out)
+    {
+        if(!primed_) {
+            window_.fill(in);
+            primed_ = true;
+        }
+        window_[pos_] = in;
+        pos_ = (pos_ + 1) % N;
+        if constexpr(N == 3) {
+            auto [a, b, c] = window_;
+            out = std::max(std::min(a, b), std::min(std::max(a, b), c));
+        }
+        else {
+            auto sorted = window_;
+            for(size_t i{1}; i < N; ++i) {
+                for(size_t j = i; j > 0 && sorted[j - 1] > sorted[j]; --j) {
+                    std::swap(sorted[j - 1], sorted[j]);
+                }
+            }
+            out = sorted[N / 2];
+        }
+        return true;
+    }
+
+private:
+    std::array<int32_t, N> window_{};
+    size_t pos_{};
+    bool primed_{};
+};
+
+/**
+ * @brief y += (x - y) / 2^SHIFT, the state keeps SHIFT fraction bits so small steps aren't lost.
+ * The time constant is about 2^SHIFT samples.
+ */
+template<size_t SHIFT>
+class SinglePoleIir
+{
+public:
+    constexpr bool Process(int32_t in, int32_t& out)
+    {
+        if(!primed_) {
+            acc_ = in * (int32_t{1} << SHIFT);
+            primed_ = true;
+        }
+        acc_ += in - (acc_ >> SHIFT);
+        out = acc_ >> SHIFT;
+        return true;
+    }
+
+private:
+    int32_t acc_{};
+    bool primed_{};
+};
+
+struct NullClock
+{
+    static constexpr uint32_t Now()
+    {
+        return 0;
+    }
+};
+
+/**
+ * @brief Stages run in order, a sample goes on while each one gives an output. No heap, no virtual calls.
+ * With a real Clock the longest run of each stage is tracked, in the clock units (CPU cycles on the target).
+ */
+template<typename Clock, FilterStage... Stages>
+class FilterChain
+{
+public:
+    static constexpr size_t STAGES = sizeof...(Stages);
+
+    constexpr bool Process(int32_t in, int32_t& out)
+    {
+        return Step<0>(in, out);
+    }
+
+    constexpr const std::array<uint32_t, STAGES>& CyclesMax() const
+    {
+        return cyclesMax_;
+    }
+
+    constexpr void ResetCycles()
+    {
+        cyclesMax_ = {};
+    }
+
+private:
+    template<size_t I>
+    constexpr bool Step(int32_t in, int32_t& out)
+    {
+        if constexpr(I == STAGES) {
+            out = in;
+            return true;
+        }
+        else {
+            int32_t next;
+            bool produced;
+            if constexpr(std::is_same_v<Clock, NullClock>) {
+                produced = std::get<I>(stages_).Process(in, next);
+            }
+            else {
+                auto start = Clock::Now();
+                produced = std::get<I>(stages_).Process(in, next);
+                cyclesMax_[I] = std::max(cyclesMax_[I], uint32_t(Clock::Now() - start));
+            }
+            return produced && Step<I + 1>(next, out);
+        }
+    }
+
+    std::tuple<Stages...> stages_;
+    std::array<uint32_t, STAGES> cyclesMax_{};
+};
+
+} // Math
+
+#endif // FILTERS_H
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <compare>
+#include <cstdint>
+
+namespace Math {
+
+/**
+ * @brief Signed 16.16 fixed point number, products and quotients are computed in 64 bit
+ */
+class Q16
+{
+public:
+    static constexpr int FRAC_BITS = 16;
+    static constexpr int32_t ONE = 1 << FRAC_BITS;
+
+    constexpr Q16() = default;
+    constexpr Q16(int val) : raw_{val * ONE}
+    { }
+    constexpr Q16(float val) : raw_{int32_t(val * ONE + (val < 0 ? -0.5f : 0.5f))}
+    { }
+    static constexpr Q16 FromRaw(int32_t raw)
+    {
+        Q16 result;
+        result.raw_ = raw;
+        return result;
+    }
+    constexpr int32_t raw() const
+    {
+        return raw_;
+    }
+    constexpr explicit operator float() const
+    {
+        return float(raw_) / ONE;
+    }
+    constexpr explicit operator int32_t() const
+    {
+        return raw_ >> FRAC_BITS;
+    }
+
+    constexpr Q16 operator-() const
+    {
+        return FromRaw(-raw_);
+    }
+    constexpr Q16& operator+=(Q16 rhs)
+    {
+        raw_ += rhs.raw_;
+        return *this;
+    }
+    constexpr Q16& operator-=(Q16 rhs)
+    {
+        raw_ -= rhs.raw_;
+        return *this;
+    }
+    constexpr Q16& operator*=(Q16 rhs)
+    {
+        raw_ = int32_t((int64_t(raw_) * rhs.raw_) >> FRAC_BITS);
+        return *this;
+    }
+    constexpr Q16& operator/=(Q16 rhs)
+    {
+        raw_ = int32_t((int64_t(raw_) << FRAC_BITS) / rhs.raw_);
+        return *this;
+    }
+    friend constexpr Q16 operator+(Q16 lhs, Q16 rhs)
+    {
+        return lhs += rhs;
+    }
+    friend constexpr Q16 operator-(Q16 lhs, Q16 rhs)
+    {
+        return lhs -= rhs;
+    }
+    friend constexpr Q16 operator*(Q16 lhs, Q16 rhs)
+    {
+        return lhs *= rhs;
+    }
+    friend constexpr Q16 operator/(Q16 lhs, Q16 rhs)
+    {
+        return lhs /= rhs;
+    }
+    friend constexpr auto operator<=>(Q16, Q16) = default;
+private:
+    int32_t raw_{};
+};
+
+} // Math
+
+#endif // FIXED_POINT_H
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include "cobs.h"
+#include "crc16.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace Utils {
+
+/**
+ * Serial link frame: type(1) seq(1) payload crc16(2, LE, CCITT-FALSE over the preceding bytes),
+ * COBS encoded and terminated by a zero
+ */
+constexpr size_t FRAME_OVERHEAD = 4;
+
+constexpr size_t MaxFrameSize(size_t payloadLen)
+{
+    return CobsEncoder::MaxEncodedSize(payloadLen + FRAME_OVERHEAD) + 1;
+}
+
+/**
+ * @return The encoded length including the delimiter, zero if it didn't fit
+ */
+inline size_t EncodeFrame(uint8_t* dst, size_t capacity, uint8_t type, uint8_t seq, const void* payload, size_t len)
+{
+    auto* bytes = static_cast<const uint8_t*>(payload);
+    const uint8_t header[]{type, seq};
+    auto crc = Crc16(bytes, len, Crc16(header, sizeof(header)));
+    const uint8_t trailer[]{uint8_t(crc), uint8_t(crc >> 8)};
+    CobsEncoder encoder{dst, capacity};
+    encoder.Put(header, sizeof(header));
+    encoder.Put(bytes, len);
+    encoder.Put(trailer, sizeof(trailer));
+    return encoder.Finish();
+}
+
+struct FrameView
+{
+    uint8_t type;
+    uint8_t seq;
+    const uint8_t* payload; // Points into the decoded buffer
+    size_t len;
+};
+
+/**
+ * @brief Decode in place and check the CRC
+ * @param len Received length without the delimiter
+ */
+inline std::optional<FrameView> DecodeFrame(uint8_t* buf, size_t len)
+{
+    len = CobsDecode(buf, len);
+    if(len < FRAME_OVERHEAD || Crc16(buf, len - 2) != uint16_t(buf[len - 2] | buf[len - 1] << 8)) {
+        return {};
+    }
+    return FrameView{.type = buf[0], .seq = buf[1], .payload = &buf[2], .len = len - FRAME_OVERHEAD};
+}
+
+} // Utils
+
+#endif // FRAME_H
@@ -22,49 +22,8 @@
 
 #include "gfx_font_renderer.h"
 
-#include <array>
-
 namespace Fonts {
 
-// Must fit the largest defined symbol
-constexpr auto CONVERT_BUF_SIZE = 20;
-
-struct GlcdFont
-{
-    const uint16_t size;
-    const uint8_t width;
-    const uint8_t height;
-    const uint8_t firstChar;
-    const uint8_t charCount;
-    const uint8_t data[];
-    constexpr uint8_t end() const
-    {
-        return firstChar + charCount;
-    }
-    constexpr bool withinRange(uint8_t letter) const
-    {
-        return letter >= firstChar || letter < end();
-    }
-    constexpr uint8_t padSize() const
-    {
-        return (width >> 3) + 1;
-    }
-    constexpr const uint8_t* getGlyphData(uint32_t letter) const
-    {
-        if(withinRange(letter)) {
-            auto index = (letter - firstChar) * width * heightBytes();
-            return &data[index];
-        }
-        else {
-            return nullptr;
-        }
-    }
-    constexpr uint8_t heightBytes() const
-    {
-        return (height >> 3) + 1;
-    }
-};
-
 /* Get info about glyph of `unicode_letter` in `font` font.
  * Store the result in `dsc_out`.
  * The next letter (`unicode_letter_next`) might be used to calculate the width required by this glyph (kerning)
@@ -74,7 +33,7 @@ bool get_glyph_dsc_cb(const lv_font_t* font,
                       uint32_t unicode_letter,
                       uint32_t /*unicode_letter_next*/)
 {
-    auto gfont = (const GlcdFont*)font->dsc;
+    auto gfont = (const GlcdFontDsc*)font->dsc;
     if(!gfont->withinRange(unicode_letter)) {
         return false;
     }
@@ -92,29 +51,7 @@ bool get_glyph_dsc_cb(const lv_font_t* font,
 /* Get the bitmap of `unicode_letter` from `font`. */
 const uint8_t* get_glyph_bitmap_cb(const lv_font_t* font, uint32_t unicode_letter)
 {
-    static uint8_t buf[CONVERT_BUF_SIZE];
-    auto gfont = (const GlcdFont*)font->dsc;
-
-    if(auto bytes = gfont->getGlyphData(unicode_letter); bytes) {
-        for(size_t h{}; h < gfont->heightBytes(); ++h) {
-            for(size_t i{}; i < gfont->width; ++i) {
-                for(size_t b{}; b < 8; ++b) {
-                    auto bitIndex = b * gfont->width + i;
-                    if(*bytes & (1 << b)) {
-                        buf[(bitIndex >> 3) + (h * gfont->width)] |= 1 << (7 - (bitIndex % 8));
-                    }
-                    else {
-                        buf[(bitIndex >> 3) + (h * gfont->width)] &= ~(1 << (7 - (bitIndex % 8)));
-                    }
-                }
-                bytes++;
-            }
-        }
-        return &buf[0];
-    }
-    else {
-        return nullptr;
-    }
+    return ((const GlcdFontDsc*)font->dsc)->getGlyphBitmap(unicode_letter);
 }
 
 } // Fonts
@@ -24,6 +24,7 @@
 #define GFX_FONT_RENDERER_H
 
 #include "lvgl.h"
+#include <array>
 
 #define GLCDFONTDECL(_n) constexpr uint8_t _n[]
 #define ADAFRUIT_ASCII96 1
@@ -52,6 +53,73 @@ constexpr struct
     size_t WIDTH_TABLE = 6;
 } GfxIndex;
 
+struct GlcdFontDsc
+{
+    uint8_t width;
+    uint8_t height;
+    uint8_t firstChar;
+    uint8_t charCount;
+    /** Row-major A1 glyphs, glyphSize() bytes each */
+    const uint8_t* bitmaps;
+
+    constexpr uint32_t end() const
+    {
+        return firstChar + charCount;
+    }
+    constexpr bool withinRange(uint32_t letter) const
+    {
+        return letter >= firstChar && letter < end();
+    }
+    constexpr uint8_t padSize() const
+    {
+        return (width >> 3) + 1;
+    }
+    constexpr uint8_t heightBytes() const
+    {
+        return (height >> 3) + 1;
+    }
+    constexpr size_t glyphSize() const
+    {
+        return width * heightBytes();
+    }
+    constexpr const uint8_t* getGlyphBitmap(uint32_t letter) const
+    {
+        return withinRange(letter) ? &bitmaps[(letter - firstChar) * glyphSize()] : nullptr;
+    }
+};
+
+template<const auto& origin>
+consteval GlcdFontDsc GetGlcdFontHeader(const uint8_t* bitmaps = nullptr)
+{
+    return {origin[GfxIndex.WIDTH], origin[GfxIndex.HEIGHT], origin[GfxIndex.FIRST_CHAR], origin[GfxIndex.CHAR_COUNT],
+            bitmaps};
+}
+
+/**
+ * @brief Transpose column-major GLCD glyphs into continuous row-major A1 bitmaps, as LVGL expects them
+ */
+template<const auto& origin>
+consteval auto ConvertGlcdFont()
+{
+    constexpr auto hdr = GetGlcdFontHeader<origin>();
+    std::array<uint8_t, hdr.charCount * hdr.glyphSize()> glyphs{};
+    size_t src = GfxIndex.WIDTH_TABLE;
+    for(size_t glyph{}; glyph < hdr.charCount; ++glyph) {
+        auto out = glyph * hdr.glyphSize();
+        for(size_t h{}; h < hdr.heightBytes(); ++h) {
+            for(size_t i{}; i < hdr.width; ++i, ++src) {
+                for(size_t b{}; b < 8; ++b) {
+                    auto bitIndex = b * hdr.width + i;
+                    if(origin[src] & (1 << b)) {
+                        glyphs[out + (bitIndex >> 3) + (h * hdr.width)] |= 1 << (7 - (bitIndex % 8));
+                    }
+                }
+            }
+        }
+    }
+    return glyphs;
+}
+
 extern bool get_glyph_dsc_cb(const lv_font_t* font,
                              lv_font_glyph_dsc_t* dsc_out,
                              uint32_t unicode_letter,
@@ -63,6 +131,8 @@ extern const uint8_t* get_glyph_bitmap_cb(const lv_font_t* font, uint32_t unicod
 #define DECLARE_LVFONT(origin) extern const lv_font_t lv_font_##origin;
 #define DEFINE_LVFONT(origin)                                                                                     \
     static_assert(origin[0] == 0 && origin[1] == 0); /*Only simple monospace fonts are supported by the wrapper*/ \
+    static constexpr auto lv_glyphs_##origin = Fonts::ConvertGlcdFont<origin>();                                  \
+    static constexpr auto lv_dsc_##origin = Fonts::GetGlcdFontHeader<origin>(lv_glyphs_##origin.data());          \
     const lv_font_t lv_font_##origin{                                                                             \
       .get_glyph_dsc = Fonts::get_glyph_dsc_cb,                      /*Set a callback to get info about glyphs*/  \
       .get_glyph_bitmap = Fonts::get_glyph_bitmap_cb,                /*Set a callback to get bitmap of a glyph*/  \
@@ -71,7 +141,7 @@ extern const uint8_t* get_glyph_bitmap_cb(const lv_font_t* font, uint32_t unicod
       .subpx = LV_FONT_SUBPX_NONE,   /*Not used for monochrome*/                                                  \
       .underline_position = 0,       /*Not used*/                                                                 \
       .underline_thickness = 0,      /*Not used*/                                                                 \
-      .dsc = (const void*)origin,    /*Store any implementation specific data here*/                              \
+      .dsc = &lv_dsc_##origin,       /*Store any implementation specific data here*/                              \
       .fallback = &lv_font_unscii_8, /*Use if glyph is absent*/                                                   \
       .user_data = nullptr,          /*Optionally some extra user data*/                                          \
     };
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INTERPOLATION_TABLE_H
+#define INTERPOLATION_TABLE_H
+
+#include "fixed_point.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Math {
+
+/**
+ * @brief Polynomial with the coefficients from the constant term up, evaluated in double for the table builds
+ */
+template<size_t N>
+struct Polynomial
+{
+    std::array<double, N> coeffs;
+
+    constexpr double operator()(double x) const
+    {
+        double result{};
+        for(size_t i = N; i-- > 0;) {
+            result = result * x + coeffs[i];
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief Piecewise linear approximation of a function over the unsigned INPUT_BITS range, built at compile time
+ * with equal segments of 2^SEGMENT_BITS. The lookup has no branches: the input is clamped, then a shift,
+ * two loads and a 32 bit multiply-add. The segment deltas must stay below 2^(31 - SEGMENT_BITS) in Q16.
+ */
+template<size_t INPUT_BITS, size_t SEGMENT_BITS>
+class InterpolationTable
+{
+public:
+    static constexpr size_t SEGMENTS = size_t{1} << (INPUT_BITS - SEGMENT_BITS);
+    static constexpr uint32_t MAX_INPUT = (uint32_t{1} << INPUT_BITS) - 1;
+
+    template<typename F>
+    consteval explicit InterpolationTable(F function)
+    {
+        for(size_t i{}; i <= SEGMENTS; ++i) {
+            auto value = function(double(i << SEGMENT_BITS)) * Q16::ONE;
+            table_[i] = int32_t(value + (value < 0 ? -0.5 : 0.5));
+        }
+    }
+
+    constexpr Q16 operator()(uint32_t x) const
+    {
+        x = std::min(x, MAX_INPUT);
+        auto index = x >> SEGMENT_BITS;
+        auto frac = int32_t(x & MASK);
+        auto y0 = table_[index];
+        return Q16::FromRaw(y0 + ((table_[index + 1] - y0) * frac >> SEGMENT_BITS));
+    }
+
+private:
+    static constexpr uint32_t MASK = (uint32_t{1} << SEGMENT_BITS) - 1;
+
+    std::array<int32_t, SEGMENTS + 1> table_{};
+};
+
+} // Math
+
+#endif // INTERPOLATION_TABLE_H
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PERFECT_HASH_H
+#define PERFECT_HASH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Utils {
+
+constexpr uint32_t Fnv1a(std::string_view str, uint32_t seed)
+{
+    uint32_t hash = 2166136261U ^ seed;
+    for(char c : str) {
+        hash = (hash ^ uint8_t(c)) * 16777619U;
+    }
+    return hash;
+}
+
+// Not constexpr, so the compilation fails if it's reached
+void NoPerfectHashSeed();
+
+/**
+ * @brief Read-only table with a collision-free hash built at compile time, a lookup costs one hash
+ * and one key comparison. T has a std::string_view code member, the key.
+ */
+template<typename T, size_t N, size_t SLOTS = 2 * N>
+class PerfectHashTable
+{
+public:
+    static_assert(N < 255, "The slots hold 8-bit indices");
+
+    static constexpr uint32_t MAX_SEED = 10'000;
+
+    consteval PerfectHashTable(const std::array<T, N>& items) : items_{items}
+    {
+        for(seed_ = 0; !TryBuild(); ++seed_) {
+            if(seed_ == MAX_SEED) {
+                NoPerfectHashSeed();
+            }
+        }
+    }
+
+    constexpr const T* Find(std::string_view key) const
+    {
+        auto index = slots_[Fnv1a(key, seed_) % SLOTS];
+        if(!index || items_[index - 1].code != key) {
+            return nullptr;
+        }
+        return &items_[index - 1];
+    }
+
+    constexpr size_t IndexOf(const T* item) const
+    {
+        return size_t(item - items_.data());
+    }
+
+    constexpr const T* At(size_t index) const
+    {
+        return index < N ? &items_[index] : nullptr;
+    }
+
+private:
+    constexpr bool TryBuild()
+    {
+        slots_ = {};
+        for(size_t i{}; i < N; ++i) {
+            auto& slot = slots_[Fnv1a(items_[i].code, seed_) % SLOTS];
+            if(slot) {
+                return false;
+            }
+            slot = uint8_t(i + 1);
+        }
+        return true;
+    }
+
+    std::array<T, N> items_;
+    std::array<uint8_t, SLOTS> slots_{}; // Item index + 1, zero is an empty slot
+    uint32_t seed_{};
+};
+
+} // Utils
+
+#endif // PERFECT_HASH_H
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PID_H
+#define PID_H
+
+#include <algorithm>
+
+namespace Math {
+
+/**
+ * @brief PID controller for float or fixed point (Q16) arithmetic, no allocations.
+ * The derivative acts on the measurement to avoid kicks on setpoint changes, the integral
+ * is frozen while the output is saturated in the direction of the error (anti-windup).
+ * The feed-forward gain scales the whole output, e.g. to compensate supply voltage changes.
+ */
+template<typename T>
+class Pid
+{
+public:
+    struct Gains
+    {
+        float kp;
+        float ki; // Per second
+        float kd; // Seconds
+    };
+
+    constexpr Pid(const Gains& gains, float dt, T outMin = T(0.0f), T outMax = T(1.0f)) :
+      outMin_{outMin}, outMax_{outMax}
+    {
+        SetGains(gains, dt);
+    }
+
+    constexpr void SetGains(const Gains& gains, float dt)
+    {
+        kp_ = T(gains.kp);
+        ki_ = T(gains.ki * dt);
+        kd_ = T(gains.kd / dt);
+    }
+
+    /**
+     * @brief Drop the accumulated state, the next update starts from the given measurement
+     */
+    constexpr void Reset(T measurement)
+    {
+        integral_ = T{};
+        prevMeasurement_ = measurement;
+        primed_ = true;
+    }
+
+    constexpr T Update(T setpoint, T measurement, T ffGain = T(1.0f))
+    {
+        if(!primed_) {
+            Reset(measurement);
+        }
+        auto error = setpoint - measurement;
+        auto p = kp_ * error;
+        auto d = kd_ * (prevMeasurement_ - measurement);
+        prevMeasurement_ = measurement;
+        auto step = ki_ * error;
+        auto candidate = (p + integral_ + step + d) * ffGain;
+        bool windupHigh = candidate > outMax_ && error > T{};
+        bool windupLow = candidate < outMin_ && error < T{};
+        if(!windupHigh && !windupLow) {
+            integral_ += step;
+        }
+        return std::clamp((p + integral_ + d) * ffGain, outMin_, outMax_);
+    }
+private:
+    T kp_{}, ki_{}, kd_{};
+    T outMin_, outMax_;
+    T integral_{};
+    T prevMeasurement_{};
+    bool primed_{};
+};
+
+} // Math
+
+#endif // PID_H
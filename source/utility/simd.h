@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+#include <arm_acle.h>
+#endif
+
+/**
+ * Column kernels over the interleaved ADC scans, two 16-bit channels per 32-bit word.
+ * On the Cortex-M4 the packed kernels use the DSP instructions, the host build falls back to plain loops.
+ * The packed kernels can run on the host with the emulated lanes to check them against the fallback.
+ */
+namespace Simd {
+
+// The lower channel of a pair is in the lower half, as a little endian load gives it
+using packed_t = uint32_t;
+
+/**
+ * @brief Lane by lane equivalents of the DSP instructions, bit exact
+ */
+struct EmulatedLanes
+{
+    static constexpr packed_t Add16(packed_t a, packed_t b)
+    {
+        return ((a + b) & 0xFFFF) | (((a >> 16) + (b >> 16)) << 16);
+    }
+
+    static constexpr packed_t Min16(packed_t a, packed_t b)
+    {
+        return Select(a, b, false);
+    }
+
+    static constexpr packed_t Max16(packed_t a, packed_t b)
+    {
+        return Select(a, b, true);
+    }
+
+    // Signed lanes, the accumulator wraps as the instruction does
+    static constexpr int32_t Mlad(packed_t a, packed_t b, int32_t acc)
+    {
+        auto lo = int32_t(int16_t(a)) * int16_t(b);
+        auto hi = int32_t(int16_t(a >> 16)) * int16_t(b >> 16);
+        return int32_t(uint32_t(acc) + uint32_t(lo) + uint32_t(hi));
+    }
+
+private:
+    static constexpr packed_t Select(packed_t a, packed_t b, bool greater)
+    {
+        packed_t result{};
+        for(unsigned shift : {0, 16}) {
+            uint32_t x = (a >> shift) & 0xFFFF, y = (b >> shift) & 0xFFFF;
+            result |= ((x >= y) == greater ? x : y) << shift;
+        }
+        return result;
+    }
+};
+
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+constexpr bool NATIVE = true;
+
+struct NativeLanes
+{
+    static packed_t Add16(packed_t a, packed_t b)
+    {
+        return __uadd16(a, b);
+    }
+
+    // USUB16 sets the GE flags of the lanes where a >= b, SEL takes its first operand there.
+    // The compiler doesn't track the GE flags, the pair must stay in one asm statement to stay together.
+    // The result is written before the operands are read for the last time, hence the early clobber.
+    static packed_t Min16(packed_t a, packed_t b)
+    {
+        packed_t result;
+        __asm("usub16 %0, %1, %2\n\t"
+              "sel %0, %2, %1"
+              : "=&r"(result)
+              : "r"(a), "r"(b)
+              : "cc");
+        return result;
+    }
+
+    static packed_t Max16(packed_t a, packed_t b)
+    {
+        packed_t result;
+        __asm("usub16 %0, %1, %2\n\t"
+              "sel %0, %1, %2"
+              : "=&r"(result)
+              : "r"(a), "r"(b)
+              : "cc");
+        return result;
+    }
+
+    static int32_t Mlad(packed_t a, packed_t b, int32_t acc)
+    {
+        return __smlad(a, b, acc);
+    }
+};
+using Lanes = NativeLanes;
+#else
+constexpr bool NATIVE = false;
+using Lanes = EmulatedLanes;
+#endif
+
+// The scans are 22 bytes long, every other one starts off the word boundary. The M4 loads those fine with LDR.
+template<typename T>
+inline packed_t Load(const T* p)
+{
+    static_assert(sizeof(T) == 2);
+    packed_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+template<size_t STRIDE, size_t ROWS>
+using Rows = std::array<std::array<uint16_t, STRIDE>, ROWS>;
+
+namespace Packed {
+
+/**
+ * @brief Per column sums of COLS columns from FIRST. The sums wrap at 16 bits,
+ * the caller keeps ROWS times the largest sample below 65536.
+ */
+template<typename L, size_t FIRST, size_t COLS, size_t STRIDE, size_t ROWS>
+void SumColumns(const Rows<STRIDE, ROWS>& rows, std::array<uint16_t, COLS>& sums)
+{
+    static_assert(FIRST + COLS <= STRIDE);
+    size_t col{};
+    for(; col + 1 < COLS; col += 2) {
+        packed_t acc{};
+        for(const auto& row : rows) {
+            acc = L::Add16(acc, Load(&row[FIRST + col]));
+        }
+        sums[col] = uint16_t(acc);
+        sums[col + 1] = uint16_t(acc >> 16);
+    }
+    if constexpr(COLS % 2) {
+        uint16_t acc{};
+        for(const auto& row : rows) {
+            acc = uint16_t(acc + row[FIRST + col]);
+        }
+        sums[col] = acc;
+    }
+}
+
+template<typename L, size_t FIRST, size_t COLS, size_t STRIDE, size_t ROWS>
+void MinMaxColumns(const Rows<STRIDE, ROWS>& rows, std::array<uint16_t, COLS>& mins, std::array<uint16_t, COLS>& maxs)
+{
+    static_assert(FIRST + COLS <= STRIDE && ROWS > 0);
+    size_t col{};
+    for(; col + 1 < COLS; col += 2) {
+        packed_t lo = Load(&rows[0][FIRST + col]), hi = lo;
+        for(size_t r{1}; r < ROWS; ++r) {
+            auto word = Load(&rows[r][FIRST + col]);
+            lo = L::Min16(lo, word);
+            hi = L::Max16(hi, word);
+        }
+        mins[col] = uint16_t(lo);
+        mins[col + 1] = uint16_t(lo >> 16);
+        maxs[col] = uint16_t(hi);
+        maxs[col + 1] = uint16_t(hi >> 16);
+    }
+    if constexpr(COLS % 2) {
+        uint16_t lo = rows[0][FIRST + col], hi = lo;
+        for(const auto& row : rows) {
+            lo = std::min(lo, row[FIRST + col]);
+            hi = std::max(hi, row[FIRST + col]);
+        }
+        mins[col] = lo;
+        maxs[col] = hi;
+    }
+}
+
+/**
+ * @brief Weighted sum of COLS channels of a scan from FIRST, the samples are taken as signed 16-bit values.
+ * The sum wraps at 32 bits.
+ */
+template<typename L, size_t FIRST, size_t COLS, size_t STRIDE>
+int32_t Dot(const std::array<uint16_t, STRIDE>& scan, const std::array<int16_t, COLS>& weights)
+{
+    static_assert(FIRST + COLS <= STRIDE);
+    int32_t acc{};
+    size_t col{};
+    for(; col + 1 < COLS; col += 2) {
+        acc = L::Mlad(Load(&scan[FIRST + col]), Load(&weights[col]), acc);
+    }
+    if constexpr(COLS % 2) {
+        acc = int32_t(uint32_t(acc) + uint32_t(int16_t(scan[FIRST + col]) * weights[col]));
+    }
+    return acc;
+}
+
+} // Packed
+
+namespace Scalar {
+
+template<size_t FIRST, size_t COLS, size_t STRIDE, size_t ROWS>
+void SumColumns(const Rows<STRIDE, ROWS>& rows, std::array<uint16_t, COLS>& sums)
+{
+    static_assert(FIRST + COLS <= STRIDE);
+    sums.fill(0);
+    for(const auto& row : rows) {
+        for(size_t col{}; col < COLS; ++col) {
+            sums[col] = uint16_t(sums[col] + row[FIRST + col]);
+        }
+    }
+}
+
+template<size_t FIRST, size_t COLS, size_t STRIDE, size_t ROWS>
+void MinMaxColumns(const Rows<STRIDE, ROWS>& rows, std::array<uint16_t, COLS>& mins, std::array<uint16_t, COLS>& maxs)
+{
+    static_assert(FIRST + COLS <= STRIDE && ROWS > 0);
+    for(size_t col{}; col < COLS; ++col) {
+        mins[col] = maxs[col] = rows[0][FIRST + col];
+    }
+    for(const auto& row : rows) {
+        for(size_t col{}; col < COLS; ++col) {
+            mins[col] = std::min(mins[col], row[FIRST + col]);
+            maxs[col] = std::max(maxs[col], row[FIRST + col]);
+        }
+    }
+}
+
+template<size_t FIRST, size_t COLS, size_t STRIDE>
+int32_t Dot(const std::array<uint16_t, STRIDE>& scan, const std::array<int16_t, COLS>& weights)
+{
+    static_assert(FIRST + COLS <= STRIDE);
+    uint32_t acc{};
+    for(size_t col{}; col < COLS; ++col) {
+        acc += uint32_t(int16_t(scan[FIRST + col]) * weights[col]);
+    }
+    return int32_t(acc);
+}
+
+} // Scalar
+
+// The firmware calls these: the DSP instructions on the target, the plain loops elsewhere
+
+template<size_t FIRST, size_t COLS, size_t STRIDE, size_t ROWS>
+inline void SumColumns(const Rows<STRIDE, ROWS>& rows, std::array<uint16_t, COLS>& sums)
+{
+    if constexpr(NATIVE) {
+        Packed::SumColumns<Lanes, FIRST>(rows, sums);
+    }
+    else {
+        Scalar::SumColumns<FIRST>(rows, sums);
+    }
+}
+
+template<size_t FIRST, size_t COLS, size_t STRIDE, size_t ROWS>
+inline void MinMaxColumns(const Rows<STRIDE, ROWS>& rows,
+                          std::array<uint16_t, COLS>& mins,
+                          std::array<uint16_t, COLS>& maxs)
+{
+    if constexpr(NATIVE) {
+        Packed::MinMaxColumns<Lanes, FIRST>(rows, mins, maxs);
+    }
+    else {
+        Scalar::MinMaxColumns<FIRST>(rows, mins, maxs);
+    }
+}
+
+template<size_t FIRST, size_t COLS, size_t STRIDE>
+inline int32_t Dot(const std::array<uint16_t, STRIDE>& scan, const std::array<int16_t, COLS>& weights)
+{
+    if constexpr(NATIVE) {
+        return Packed::Dot<Lanes, FIRST>(scan, weights);
+    }
+    else {
+        return Scalar::Dot<FIRST>(scan, weights);
+    }
+}
+
+} // Simd
+
+#endif // SIMD_H
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2023 Dmytro Shestakov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace Utils {
+
+/**
+ * @brief Lock-free single producer single consumer ring, either side may run in an ISR.
+ * One slot is kept empty to tell a full ring from an empty one.
+ */
+template<typename T, size_t N>
+class SpscRing
+{
+public:
+    static_assert(N > 1 && (N & (N - 1)) == 0, "Size must be a power of 2");
+
+    bool Push(const T& value)
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        auto next = (head + 1) & MASK;
+        if(next == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        buf_[head] = value;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& value)
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if(tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = buf_[tail];
+        tail_.store((tail + 1) & MASK, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief All or nothing, the consumer sees the values at once
+     */
+    bool Push(const T* values, size_t count)
+    {
+        auto head = head_.load(std::memory_order_relaxed);
+        if(count > ((tail_.load(std::memory_order_acquire) - head - 1) & MASK)) {
+            return false;
+        }
+        for(size_t i{}; i < count; ++i) {
+            buf_[(head + i) & MASK] = values[i];
+        }
+        head_.store((head + count) & MASK, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T* values, size_t count)
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if(count > ((head_.load(std::memory_order_acquire) - tail) & MASK)) {
+            return false;
+        }
+        for(size_t i{}; i < count; ++i) {
+            values[i] = buf_[(tail + i) & MASK];
+        }
+        tail_.store((tail + count) & MASK, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Consumer side, the oldest value without removing it
+     */
+    bool Peek(T& value) const
+    {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if(tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = buf_[tail];
+        return true;
+    }
+
+    /**
+     * @brief Producer side, the consumer may only increase it concurrently
+     */
+    size_t Free() const
+    {
+        return (tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_relaxed) - 1) & MASK;
+    }
+
+    bool Empty() const
+    {
+        return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+private:
+    static constexpr size_t MASK = N - 1;
+    std::array<T, N> buf_;
+    std::atomic<size_t> head_{};
+    std::atomic<size_t> tail_{};
+};
+
+} // Utils
+
+#endif // SPSC_RING_H
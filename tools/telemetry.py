@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+#
+# Decoder for the station telemetry link (USART1, see source/impl/telemetry.h).
+# Samples go to stdout as CSV, the console text and the log records to stderr. --plot shows the irons live
+# (needs matplotlib). The log records carry the format string addresses, --elf gives the image to look them up.
+#
+# Usage: telemetry.py [--baud 5250000] [--plot] [--elf build/jbc_station.elf] <serial port | capture file | ->
+
+import argparse
+import re
+import struct
+import sys
+from collections import deque
+
+FRAME_SAMPLE = 1
+FRAME_TEXT = 2
+FRAME_LOG = 3
+IRONS = 3
+IRON_FIELDS = ("temperature", "setpoint", "duty", "volts", "amps")
+SAMPLE = struct.Struct("<II" + "f" * len(IRON_FIELDS) * IRONS)
+
+
+def crc16(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = (crc << 1 ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Image:
+    """The loaded sections of an ELF file, the log formats and %s arguments are read from them"""
+
+    def __init__(self, path):
+        with open(path, "rb") as file:
+            self.data = file.read()
+        if self.data[:4] != b"\x7fELF" or self.data[5] != 1:
+            raise ValueError(f"{path} is not a little-endian ELF file")
+        wide = self.data[4] == 2
+        self.word = struct.Struct("<Q" if wide else "<I")
+        shoff, = struct.unpack_from("<Q" if wide else "<I", self.data, 0x28 if wide else 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x3A if wide else 0x2E)
+        header = struct.Struct("<4xI8xQQQ" if wide else "<4xI4xIII")
+        self.sections = []
+        for i in range(shnum):
+            kind, addr, offset, size = header.unpack_from(self.data, shoff + i * shentsize)
+            # SHT_NOBITS has nothing in the file
+            if addr and kind != 8:
+                self.sections.append((addr, offset, size))
+
+    def string(self, addr):
+        for start, offset, size in self.sections:
+            if start <= addr < start + size:
+                begin = offset + addr - start
+                return self.data[begin:self.data.index(b"\0", begin)].decode(errors="replace")
+        return None
+
+
+# chprintf conversions, the upper case ones and "l" are the long variants
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)l?([diouxcspDIOUX%])")
+
+
+def format_record(image, words):
+    """A DeferredLog record: time (1 ms ticks), format address, argument count, arguments"""
+    time, fmt_addr, count, *args = words
+    fmt = image.string(fmt_addr) if image else None
+    if fmt is None:
+        return f"{time:8} <{fmt_addr:#x}> " + " ".join(f"{arg:#x}" for arg in args[:count])
+    bits = image.word.size * 8
+    args = iter(args[:count])
+
+    def convert(match):
+        flags, kind = match.groups()
+        if kind == "%":
+            return "%"
+        value = next(args, 0)
+        if kind in "diDI":
+            return f"%{flags}d" % (value - (1 << bits) if value >> (bits - 1) else value)
+        if kind == "s":
+            return f"%{flags}s" % (image.string(value) or f"<{value:#x}>")
+        if kind == "c":
+            return chr(value & 0xFF)
+        if kind == "p":
+            return f"{value:#x}"
+        return f"%{flags}{kind.lower()}" % value
+
+    return f"{time:8} " + CONVERSION.sub(convert, fmt)
+
+
+def frames(stream):
+    """Yield (type, seq, payload) of the valid frames, the broken ones are counted and skipped"""
+    pending = bytearray()
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            return
+        pending += chunk
+        *complete, pending = pending.split(b"\0")
+        pending = bytearray(pending)
+        for raw in complete:
+            frame = cobs_decode(raw) if raw else None
+            if not frame or len(frame) < 4 or crc16(frame[:-2]) != struct.unpack_from("<H", frame, len(frame) - 2)[0]:
+                frames.errors += 1
+                continue
+            yield frame[0], frame[1], frame[2:-2]
+
+
+frames.errors = 0
+
+
+def open_input(name, baud):
+    if name == "-":
+        return sys.stdin.buffer
+    try:
+        import serial
+        return serial.Serial(name, baud, timeout=1)
+    except (ImportError, ValueError, OSError):
+        return open(name, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("input")
+    parser.add_argument("--baud", type=int, default=5250000)
+    parser.add_argument("--plot", action="store_true")
+    parser.add_argument("--window", type=int, default=1000, help="samples shown by --plot")
+    parser.add_argument("--elf", help="firmware image the log records refer to")
+    args = parser.parse_args()
+    image = Image(args.elf) if args.elf else None
+    # The record words are pointer sized, 4 bytes on the target
+    word = image.word if image else struct.Struct("<I")
+
+    columns = ["time_ms", "cut_off"] + [f"{field}{iron + 1}" for iron in range(IRONS) for field in IRON_FIELDS]
+    print(",".join(columns))
+    history = deque(maxlen=args.window)
+    plot = None
+    if args.plot:
+        import matplotlib.pyplot as plt
+        plt.ion()
+        figure, axes = plt.subplots(2, sharex=True)
+        plot = (plt, figure, axes)
+
+    last_seq = None
+    lost = 0
+    for kind, seq, payload in frames(open_input(args.input, args.baud)):
+        if last_seq is not None:
+            lost += (seq - last_seq - 1) & 0xFF
+        last_seq = seq
+        if kind == FRAME_TEXT:
+            sys.stderr.write(payload.decode(errors="replace"))
+        elif kind == FRAME_LOG and len(payload) % word.size == 0:
+            words = [value for value, in word.iter_unpack(payload)]
+            print(format_record(image, words), file=sys.stderr)
+        elif kind == FRAME_SAMPLE and len(payload) == SAMPLE.size:
+            values = SAMPLE.unpack(payload)
+            print(",".join(f"{v:.3f}" if isinstance(v, float) else str(v) for v in values))
+            history.append(values)
+            if plot and len(history) % 10 == 0:
+                redraw(plot, history)
+    print(f"lost frames {lost}, broken frames {frames.errors}", file=sys.stderr)
+
+
+def redraw(plot, history):
+    plt, figure, (temperature, duty) = plot
+    time = [s[0] / 1000 for s in history]
+    temperature.cla()
+    duty.cla()
+    for iron in range(IRONS):
+        base = 2 + iron * len(IRON_FIELDS)
+        temperature.plot(time, [s[base] for s in history], label=f"iron {iron + 1}")
+        temperature.plot(time, [s[base + 1] for s in history], linestyle="--")
+        duty.plot(time, [s[base + 2] for s in history])
+    temperature.set_ylabel("°C")
+    temperature.legend(loc="upper left")
+    duty.set_ylabel("duty")
+    duty.set_xlabel("s")
+    figure.canvas.draw_idle()
+    plt.pause(0.001)
+
+
+if __name__ == "__main__":
+    main()